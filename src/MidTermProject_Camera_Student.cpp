@@ -4,7 +4,9 @@
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <cctype>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -15,27 +17,258 @@
 
 #include "dataStructures.h"
 #include "matching2D.hpp"
+#include "frameCache.hpp"
+#include "featureTracking.hpp"
+#include "threadPool.hpp"
+#include "streamingPipeline.hpp"
+#include "frameSource.hpp"
+#include "streamScheduler.hpp"
+#include "typedPipeline.hpp"
 
 
 using namespace std;
 
-template <typename typeT>
-double calcAvg(std::vector<typeT>& vec)
-{
-    double sum = 0;
-    for (typeT elem : vec)
-    {
-        sum += elem;
-    }
-    return sum/vec.size();
-} 
-
 /* MAIN PROGRAM */
+// usage: 2D_feature_tracking [--parallel [numThreads]] [--pipeline <detector> <descriptor>] [--roi-detect]
+//                             [--matcher MAT_BF|MAT_FLANN] [--lsh <tables> <keySize> <multiProbe>] [--eval-recall]
+//                             [--gated [searchRadius]] [--budget <maxKeypoints> [GRID|ANMS|BEST]] [--no-fused]
+//                             [--out-dir <dir>] [--feature-store <dir>] [--klt [keyframeInterval]]
+//                             [--quantize] [--source <spec>] [--multi-ref <K>] [--target-kpts <min> <max>]
+//                             [--verify [HOMOGRAPHY|FUNDAMENTAL]] [--typed <detector> <descriptor>]
+//                             [--frame-cache <file>]
+//                             [--streams <detector> <descriptor> [fps]] [--stream <spec>]...
+//   --parallel : run the detector x descriptor combinations concurrently on a thread pool
+//                (numThreads defaults to the number of cores)
+//   --pipeline : stream a single combination through the multi-threaded load/detect/describe/match
+//                pipeline and report per-stage occupancy instead of running the sweep
+//                (not with --klt, --multi-ref, --feature-store or --eval-recall)
+//   --roi-detect : detect inside the (padded) vehicle ROI only instead of filtering full-frame detections
+//   --matcher    : descriptor matcher, MAT_FLANN uses multi-probe LSH for binary descriptors
+//   --lsh        : LSH index parameters for MAT_FLANN (defaults 12 20 2)
+//   --eval-recall: report the recall of an approximate matcher against exact brute force matching
+//   --gated      : match only within a window (default radius 16 px) around the motion-predicted position
+//   --budget     : cap the keypoints per ROI before description, spread by grid bucketing (default) or ANMS
+//   --no-fused   : detect and describe same-family pairs (ORB, BRISK, AKAZE, SIFT) in two passes
+//   --out-dir    : directory the averaged result tables are written to (default ../src/)
+//   --klt        : detect + describe every keyframeInterval-th frame only (default 5, earlier when the tracks
+//                  thin out) and track the keypoints with pyramidal Lucas-Kanade flow in between
+//   --quantize   : keep float descriptors (SIFT) as RootSIFT uint8 (4x smaller) and match them with integer L2
+//   --source     : frames from seq:<printf pattern>[:first[:last]], glob:<pattern>, video:<path> or
+//                  raw:<path or ->:<width>x<height> instead of the KITTI sequence. They are read ahead and decoded
+//                  on background threads; --pipeline streams them (any length), the sweep caches them first
+//   --multi-ref  : also match every frame against the last K frames in one pass, so keypoints lost for a frame
+//                  (occlusion, blur) are found again
+//   --target-kpts: adapt the detector threshold (FAST/BRISK/AKAZE threshold, ORB nfeatures, Shi-Tomasi/Harris
+//                  quality level) frame to frame so the keypoints in the ROI stay within [min, max]
+//   --verify     : fit a homography (default) or fundamental matrix to each frame's matches with PROSAC and
+//                  mark the inliers (DataFrame::kptMatchInliers)
+//   --typed      : run one of the compile-time configured pipelines (typedPipeline.hpp: SHITOMASI+BRISK,
+//                  FAST+BRIEF, FAST+ORB, ORB+ORB, BRISK+BRISK, AKAZE+AKAZE, SIFT+SIFT) instead of the sweep;
+//                  the sweep runs these pairs on the same typed detector / descriptor (typedFeatures.hpp)
+//   --frame-cache: file of raw 8-bit gray frames which is memory-mapped instead of decoding the PNGs (written on
+//                  the first run, rebuilt when an image file changes)
+//   --streams    : process several sequences at once (each --stream <spec>, see --source; default the KITTI
+//                  sequence) on one shared pool of --parallel workers, earliest deadline first, replayed at fps
+//                  (0 = as fast as possible), and report throughput and deadline misses per stream
+//                  (not with --klt, --multi-ref, --feature-store, --eval-recall, --source or --frame-cache)
+//   --feature-store : directory of memory-mapped keypoint + descriptor files; frames found there (same pixels
+//                     and detection settings) skip detection and description, the others are added
+// For latency percentiles per stage use the 2D_feature_benchmark target instead.
 int main(int argc, const char *argv[])
 {
 
     /* INIT VARIABLES AND DATA STRUCTURES */
 
+    bool bParallel = false;
+    size_t numThreads = 0; // 0 = one per core
+    bool bPipeline = false;
+    bool bDetectInRoi = false;
+    string matcherType = "MAT_BF"; // MAT_BF, MAT_FLANN
+    LshParams lshParams;
+    bool bEvalRecall = false;
+    bool bGatedMatching = false;
+    GridMatchParams gridParams;
+    bool bLimitKpts = false;
+    KeypointBudget budget;
+    bool bFusedDetDesc = true;
+    string outputDir = "../src/";
+    string featureStoreDir; // empty = no feature store
+    string rawFrameCache; // optional: file of raw 8-bit gray frames which is memory-mapped instead of decoding the PNGs
+    bool bKltTracking = false;
+    bool bQuantizeFloat = false;
+    string sourceSpec; // empty = the KITTI sequence below
+    int numReferenceFrames = 1;
+    bool bAdaptiveThreshold = false;
+    bool bVerifyMatches = false;
+    VerifyParams verifyParams;
+    AdaptiveThresholdParams adaptiveThreshold;
+    bool bTyped = false;
+    string typedDetector, typedDescriptor;
+    bool bStreams = false;
+    string streamDetector, streamDescriptor;
+    double streamFps = 0.0;
+    vector<string> streamSpecs;
+    KltParams kltParams;
+    string pipelineDetector, pipelineDescriptor;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.compare("--parallel") == 0)
+        {
+            bParallel = true;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+            {
+                numThreads = strtoul(argv[++i], nullptr, 10);
+            }
+        }
+        else if (arg.compare("--pipeline") == 0 && i + 2 < argc)
+        {
+            bPipeline = true;
+            pipelineDetector = argv[++i];
+            pipelineDescriptor = argv[++i];
+        }
+        else if (arg.compare("--roi-detect") == 0)
+        {
+            bDetectInRoi = true;
+        }
+        else if (arg.compare("--matcher") == 0 && i + 1 < argc)
+        {
+            matcherType = argv[++i];
+        }
+        else if (arg.compare("--lsh") == 0 && i + 3 < argc)
+        {
+            lshParams.tableNumber = atoi(argv[++i]);
+            lshParams.keySize = atoi(argv[++i]);
+            lshParams.multiProbeLevel = atoi(argv[++i]);
+        }
+        else if (arg.compare("--eval-recall") == 0)
+        {
+            bEvalRecall = true;
+        }
+        else if (arg.compare("--gated") == 0)
+        {
+            bGatedMatching = true;
+            const char *next = i + 1 < argc ? argv[i + 1] : "";
+            if (isdigit(next[0]) || ((next[0] == '-' || next[0] == '.') && isdigit(next[1])))
+            {   // the radius is also the grid cell size, so it has to be positive
+                char *end = nullptr;
+                double radius = strtod(argv[++i], &end);
+                if (*end != '\0' || !(radius > 0.0) || !std::isfinite(radius))
+                {
+                    std::cout << "--gated: search radius must be a number > 0, got " << argv[i] << std::endl;
+                    return 1;
+                }
+                gridParams.searchRadius = (float)radius;
+                gridParams.cellSize = gridParams.searchRadius;
+            }
+        }
+        else if (arg.compare("--budget") == 0 && i + 1 < argc)
+        {
+            bLimitKpts = true;
+            budget.maxKeypoints = atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                budget.method = parseBudgetMethod(argv[++i]);
+                if (budget.method == BUDGET_INVALID)
+                {
+                    cout << "--budget: method must be GRID, ANMS or BEST, got " << argv[i] << endl;
+                    return 1;
+                }
+            }
+        }
+        else if (arg.compare("--no-fused") == 0)
+        {
+            bFusedDetDesc = false;
+        }
+        else if (arg.compare("--out-dir") == 0 && i + 1 < argc)
+        {
+            outputDir = argv[++i];
+            if (!outputDir.empty() && outputDir.back() != '/')
+            {
+                outputDir += "/";
+            }
+        }
+        else if (arg.compare("--streams") == 0 && i + 2 < argc)
+        {
+            bStreams = true;
+            streamDetector = argv[++i];
+            streamDescriptor = argv[++i];
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+            {
+                streamFps = atof(argv[++i]);
+            }
+        }
+        else if (arg.compare("--stream") == 0 && i + 1 < argc)
+        {
+            streamSpecs.push_back(argv[++i]);
+        }
+        else if (arg.compare("--multi-ref") == 0 && i + 1 < argc)
+        {
+            numReferenceFrames = max(1, atoi(argv[++i]));
+        }
+        else if (arg.compare("--target-kpts") == 0 && i + 2 < argc)
+        {
+            bAdaptiveThreshold = true;
+            adaptiveThreshold.targetMin = atoi(argv[++i]);
+            adaptiveThreshold.targetMax = max(adaptiveThreshold.targetMin, atoi(argv[++i]));
+        }
+        else if (arg.compare("--typed") == 0 && i + 2 < argc)
+        {
+            bTyped = true;
+            typedDetector = argv[++i];
+            typedDescriptor = argv[++i];
+        }
+        else if (arg.compare("--verify") == 0)
+        {
+            bVerifyMatches = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                verifyParams.model = argv[++i];
+            }
+            if (!isVerifyModel(verifyParams.model))
+            {
+                std::cout << "--verify: model must be HOMOGRAPHY or FUNDAMENTAL, got " << verifyParams.model << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.compare("--source") == 0 && i + 1 < argc)
+        {
+            sourceSpec = argv[++i];
+        }
+        else if (arg.compare("--quantize") == 0)
+        {
+            bQuantizeFloat = true;
+        }
+        else if (arg.compare("--klt") == 0)
+        {
+            bKltTracking = true;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+            {
+                kltParams.keyframeInterval = atoi(argv[++i]);
+            }
+        }
+        else if (arg.compare("--frame-cache") == 0 && i + 1 < argc)
+        {
+            rawFrameCache = argv[++i];
+        }
+        else if (arg.compare("--feature-store") == 0 && i + 1 < argc)
+        {
+            featureStoreDir = argv[++i];
+        }
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--parallel [numThreads]] [--pipeline <detector> <descriptor>] [--roi-detect]"
+                      << " [--matcher MAT_BF|MAT_FLANN] [--lsh <tables> <keySize> <multiProbe>] [--eval-recall]"
+                      << " [--gated [searchRadius]] [--budget <maxKeypoints> [GRID|ANMS|BEST]] [--no-fused]"
+                      << " [--out-dir <dir>] [--feature-store <dir>] [--klt [keyframeInterval]]"
+                      << " [--quantize] [--source <spec>] [--multi-ref <K>] [--target-kpts <min> <max>]"
+                      << " [--verify [HOMOGRAPHY|FUNDAMENTAL]] [--typed <detector> <descriptor>]"
+                      << " [--frame-cache <file>]"
+                      << " [--streams <detector> <descriptor> [fps]] [--stream <spec>]..." << std::endl;
+            return 1;
+        }
+    }
+
     // data location
     string dataPath = "../";
 
@@ -47,249 +280,277 @@ int main(int argc, const char *argv[])
     int imgEndIndex = 9;   // last file index to load
     int imgFillWidth = 4;  // no. of digits which make up the file index (e.g. img-0001.png)
 
-    // misc
-    int dataBufferSize = 2;       // no. of images which are held in memory (ring buffer) at the same time
-    vector<DataFrame> dataBuffer; // list of data frames which are held in memory at the same time
+    // settings shared by all combinations (see TrackingConfig for the available options)
+    TrackingConfig baseConfig;
+    baseConfig.dataBufferSize = 2;  // no. of images which are held in memory (ring buffer) at the same time
+    baseConfig.bVis = false;        // visualize results
+    baseConfig.bVerbose = !bParallel;
+    baseConfig.bDetectInRoi = bDetectInRoi;
+    baseConfig.matcherType = matcherType;
+    baseConfig.lshParams = lshParams;
+    if (bEvalRecall && numReferenceFrames > 1)
+    {
+        std::cout << "--eval-recall is not supported together with --multi-ref" << std::endl;
+        return 1;
+    }
+    if (bStreams || bPipeline)
+    {   // these modes only detect, describe, match and verify each frame
+        vector<string> unsupported;
+        if (bKltTracking)
+        {
+            unsupported.push_back("--klt");
+        }
+        if (numReferenceFrames > 1)
+        {
+            unsupported.push_back("--multi-ref");
+        }
+        if (!featureStoreDir.empty())
+        {
+            unsupported.push_back("--feature-store");
+        }
+        if (bEvalRecall)
+        {
+            unsupported.push_back("--eval-recall");
+        }
+        if (bStreams && !sourceSpec.empty())
+        {
+            unsupported.push_back("--source (use --stream)");
+        }
+        if (bStreams && !rawFrameCache.empty())
+        {
+            unsupported.push_back("--frame-cache");
+        }
+        if (!unsupported.empty())
+        {
+            std::cout << (bStreams ? "--streams" : "--pipeline") << " does not support";
+            for (const string &option : unsupported)
+            {
+                std::cout << " " << option;
+            }
+            std::cout << std::endl;
+            return 1;
+        }
+    }
+    baseConfig.bEvalRecall = bEvalRecall;
+    baseConfig.bGatedMatching = bGatedMatching;
+    baseConfig.gridParams = gridParams;
+    baseConfig.bLimitKpts = bLimitKpts;
+    baseConfig.budget = budget;
+    baseConfig.bFusedDetDesc = bFusedDetDesc;
+    baseConfig.featureStoreDir = featureStoreDir;
+    baseConfig.bKltTracking = bKltTracking;
+    baseConfig.bQuantizeFloat = bQuantizeFloat;
+    baseConfig.numReferenceFrames = numReferenceFrames;
+    baseConfig.klt = kltParams;
+    baseConfig.bAdaptiveThreshold = bAdaptiveThreshold;
+    baseConfig.bVerifyMatches = bVerifyMatches;
+    baseConfig.verifyParams = verifyParams;
+    baseConfig.adaptiveThreshold = adaptiveThreshold;
+
+    // decode + grayscale-convert every frame once, all detector/descriptor combinations share the result
+    vector<string> imgFilenames;
+    for (int imgIndex = imgStartIndex; imgIndex <= imgEndIndex; imgIndex++)
+    {
+        // assemble filenames for current index
+        ostringstream imgNumber;
+        imgNumber << setfill('0') << setw(imgFillWidth) << imgIndex;
+        imgFilenames.push_back(imgBasePath + imgPrefix + imgNumber.str() + imgFileType);
+    }
+    if (bStreams)
+    {
+        TrackingConfig config = baseConfig;
+        config.detectorType = streamDetector;
+        config.descriptorType = streamDescriptor;
+        config.bVerbose = false;
+        if (!isSupportedCombination(config.detectorType, config.descriptorType))
+        {
+            std::cout << "Combination " << config.detectorType << ", " << config.descriptorType << " not supported" << std::endl;
+            return 1;
+        }
+        if (streamSpecs.empty())
+        {   // the KITTI sequence as a single stream
+            ostringstream spec;
+            spec << "seq:" << imgBasePath << imgPrefix << "%0" << imgFillWidth << "d" << imgFileType << ":" << imgStartIndex
+                 << ":" << imgEndIndex;
+            streamSpecs.push_back(spec.str());
+        }
+        if (numThreads == 0)
+        {
+            numThreads = max(1u, std::thread::hardware_concurrency());
+        }
+
+        StreamScheduler scheduler(numThreads);
+        StreamTiming timing;
+        timing.fps = streamFps;
+        for (size_t s = 0; s < streamSpecs.size(); ++s)
+        {
+            unique_ptr<FrameSource> source = createFrameSource(streamSpecs[s]);
+            if (!source)
+            {
+                return 1;
+            }
+            scheduler.addStream("stream " + to_string(s), move(source), config, timing);
+        }
+        vector<StreamReport> reports = scheduler.run();
+        std::cout << reports.size() << " streams (" << config.detectorType << ", " << config.descriptorType << ") on "
+                  << numThreads << " workers in " << scheduler.wallTime() * 1000 << " ms" << std::endl;
+        for (const StreamReport &report : reports)
+        {
+            std::cout << "  " << report.name << ": " << report.numFrames << " frames, " << fixed << setprecision(1)
+                      << report.throughput << " fps, latency p50 " << report.latency.p50 << " / p99 " << report.latency.p99
+                      << " / max " << report.latency.max << " ms, " << report.numDeadlineMisses << " deadline misses, "
+                      << report.numDropped << " dropped, " << report.numBackpressure << " paused" << defaultfloat << std::endl;
+        }
+        return 0;
+    }
+
+    unique_ptr<FrameSource> frameSource;
+    if (!sourceSpec.empty())
+    {
+        frameSource = createFrameSource(sourceSpec);
+        if (!frameSource)
+        {
+            return 1;
+        }
+    }
+    FrameCache frameCache;
+    if (!(bPipeline && frameSource)) // the pipeline streams a given source instead of caching it
+    {
+        if (!(frameSource ? frameCache.load(*frameSource) : frameCache.load(imgFilenames, rawFrameCache)))
+        {
+            return 1;
+        }
+        std::cout << "Loaded " << frameCache.size() << " frames in " << frameCache.loadTime() * 1000 << " ms"
+                  << (frameCache.isMapped() ? " (memory-mapped)" : "") << std::endl;
+    }
+
+    if (bTyped)
+    {
+        return runTypedPipeline(typedDetector, typedDescriptor, frameCache, baseConfig) ? 0 : 1;
+    }
 
-    bool bVis = false;            // visualize results
+    if (bPipeline)
+    {
+        TrackingConfig config = baseConfig;
+        config.detectorType = pipelineDetector;
+        config.descriptorType = pipelineDescriptor;
+        config.bVerbose = false;
+        if (!isSupportedCombination(config.detectorType, config.descriptorType))
+        {
+            std::cout << "Combination " << config.detectorType << ", " << config.descriptorType << " not supported" << std::endl;
+            return 1;
+        }
+        balanceThreads(3); // detect, describe and match run concurrently
+
+        FrameCallback report = [](const DataFrame &frame, size_t frameIndex) {
+            std::cout << "Frame " << frameIndex << ": " << frame.keypoints.size() << " keypoints, "
+                      << frame.kptMatches.size() << " matches" << std::endl;
+        };
+        PipelineResult result;
+        if (frameSource)
+        {   // I/O and decoding run ahead on their own threads, the load stage only takes finished frames
+            FramePrefetcher prefetcher(*frameSource);
+            result = runPipeline(config, prefetcher, 2, report);
+        }
+        else
+        {
+            result = runPipeline(config, frameCache, 2, report);
+        }
+        std::cout << "Pipeline " << config.detectorType << ", " << config.descriptorType << ": " << result.numFrames
+                  << " frames in " << result.wallTime * 1000 << " ms, latency avg " << result.avgLatency * 1000
+                  << " ms / max " << result.maxLatency * 1000 << " ms (setup " << result.setupTime * 1000 << " ms)" << std::endl;
+        for (const StageStats &stage : result.stages)
+        {
+            std::cout << "  " << setw(8) << stage.name << ": busy " << setw(9) << stage.busyTime * 1000 << " ms, occupancy "
+                      << setw(5) << fixed << setprecision(1) << stage.occupancy * 100 << " %, starved " << stage.inputWaits
+                      << ", blocked " << stage.outputWaits << defaultfloat << std::endl;
+        }
+        return 0;
+    }
 
-    vector<int> tenImgKptsNum;
-    vector<int> tenImgMatchedKptsNum;
-    vector<double> tenImgDetDescTime;
-    std::ofstream outKptsNum("../src/all_kpts_num.txt");
-    std::ofstream outKptsMatchedNum("../src/all_kpts_matched_num.txt");
-    std::ofstream outDetDescTime("../src/all_detdesc_time.txt");
     vector<string> detVec = {"SHITOMASI", "HARRIS", "FAST", "BRISK", "ORB", "AKAZE", "SIFT"};
     vector<string> descVec = {"BRISK", "BRIEF", "ORB", "FREAK", "AKAZE", "SIFT"};
     //Akaze as a Descriptor doesn't work with any detectors apart from itself
-    //SIFT and ORB go out of memory
+    //(SIFT + ORB fits the descriptor memory budget now, see NOTE 1)
 
     // Taking various combos of detector and descriptors:
-    for (string detectorType : detVec)
+    // results[row = detector][col = descriptor], filled in whatever order the combinations finish
+    vector<vector<CombinationResult>> results(detVec.size(), vector<CombinationResult>(descVec.size()));
+    double t = (double)cv::getTickCount();
+    if (bParallel)
     {
-        for (string descriptorType : descVec)
-        {    
-            // ClearBuffer o that when the type changes (from SHITOM,BRISK to SHITOM,BRIEF), mixed up 
-            // comparisons should not be done (previous SHITOM,BRISK compared with latest SHITOM,BRIEF)
-            dataBuffer.clear();
-            tenImgKptsNum.clear();
-            tenImgMatchedKptsNum.clear();
-            tenImgDetDescTime.clear();
-            for (size_t imgIndex = 0; imgIndex <= imgEndIndex - imgStartIndex; imgIndex++)
-            //for (size_t imgIndex = 0; imgIndex <= 3; imgIndex++)
+        size_t numCombinations = detVec.size() * descVec.size();
+        if (numThreads == 0)
+        {
+            numThreads = max(1u, std::thread::hardware_concurrency());
+        }
+        numThreads = min(numThreads, numCombinations);
+        int innerThreads = balanceThreads(numThreads);
+        std::cout << "Parallel sweep: " << numThreads << " workers x " << innerThreads << " OpenCV threads" << std::endl;
+
+        ThreadPool pool(numThreads);
+        for (size_t row = 0; row < detVec.size(); ++row)
+        {
+            for (size_t col = 0; col < descVec.size(); ++col)
             {
-                //Akaze as a Descriptor doesn't work with any detectors apart from itself
-                //SIFT and ORB go out of memory (Too many points picked up)
-                if ( !(detectorType.compare("AKAZE")==0)&&(descriptorType.compare("AKAZE")==0) ||
-                     (detectorType.compare("SIFT")==0)&&(descriptorType.compare("ORB")==0) )
-                {
-                    std::cout << "Skipping...";
-                    std::cout << "Using: " << detectorType << ", " << descriptorType << std::endl;
-                    outKptsNum << "NaN" << ", ";
-                    outKptsMatchedNum << "NaN" << ", ";
-                    outDetDescTime << "NaN" << ", ";                    
-                    break;
-                }
-
-                //Also, On continuation of the loop, randomly it crashes for a new descriptorType. 
-                //But works when run independently with that descriptor.
-                //Check variable states. Ensure they are reinitialized correctly.
-
-                std::cout << "Using: " << detectorType << ", " << descriptorType << std::endl;
-                /* LOAD IMAGE INTO BUFFER */
-                // assemble filenames for current index
-                ostringstream imgNumber;
-                imgNumber << setfill('0') << setw(imgFillWidth) << imgStartIndex + imgIndex;
-                string imgFullFilename = imgBasePath + imgPrefix + imgNumber.str() + imgFileType;
-
-                // load image from file and convert to grayscale
-                cv::Mat img, imgGray;
-                img = cv::imread(imgFullFilename);
-                cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
-
-                /* Ring Buffer Implementation */
-                // push image into data frame buffer
-                DataFrame frame;
-                frame.cameraImg = imgGray;
-                // Needs to only hold two images since a constant velocity model is being used. 
-                // Else might need upto 3 or more (if acceleration etc model are used).
-                dataBuffer.push_back(frame);
-                if (dataBuffer.size() > dataBufferSize)
-                {
-                    dataBuffer.erase(dataBuffer.end());
-                }
-                // cout << "#1 : LOAD IMAGE INTO BUFFER done" << endl;
-
-
-                /* DETECT IMAGE KEYPOINTS */
-                // extract 2D keypoints from current image
-                vector<cv::KeyPoint> keypoints; // create empty feature list for current image
-                // string detectorType = "SHITOMASI";
-                // string detectorType = "HARRIS";
-                // string detectorType = "FAST";
-                // string detectorType = "BRISK";
-                // string detectorType = "ORB";
-                // string detectorType = "AKAZE";
-                // string detectorType = "SIFT";
-
-                double keyTime = 0;
-                if (detectorType.compare("SHITOMASI") == 0)
-                {
-                    keyTime = detKeypointsShiTomasi(keypoints, imgGray, false);
-                }
-                else if (detectorType.compare("HARRIS") == 0)
-                {
-                    keyTime = detKeypointsHarris(keypoints, imgGray, false);
-                }
-                else if ( (detectorType.compare("FAST") == 0) ||
-                        (detectorType.compare("BRISK") == 0) ||
-                        (detectorType.compare("ORB") == 0) ||
-                        (detectorType.compare("AKAZE") == 0) ||
-                        (detectorType.compare("SIFT") == 0) )
-                {
-                    keyTime = detKeypointsModern(keypoints, imgGray, detectorType, false);
-                }
-                else
-                {
-                    std::cout << "detectorType NOT SUPPORTED" << std::endl;
-                }
-
-                /* Maintaining keypoints of vehicle only */
-                // only keep keypoints on the preceding vehicle
-                bool bFocusOnVehicle = true;
-                vector<cv::KeyPoint> vehicleKeypoints;
-                cv::Rect vehicleRect(535, 180, 180, 150);
-                if (bFocusOnVehicle)
-                {
-                    for (cv::KeyPoint kp : keypoints)
-                    {
-                        if(vehicleRect.contains(kp.pt))
-                        {
-                            vehicleKeypoints.push_back(kp);
-                        }
-                    }
-                    keypoints = vehicleKeypoints;
-                }
-
-                // optional : limit number of keypoints (helpful for debugging and learning)
-                bool bLimitKpts = false;
-                if (bLimitKpts)
-                {
-                    int maxKeypoints = 50;
-
-                    if (detectorType.compare("SHITOMASI") == 0)
-                    { // there is no response info, so keep the first 50 as they are sorted in descending quality order
-                        keypoints.erase(keypoints.begin() + maxKeypoints, keypoints.end());
-                    }
-                    cv::KeyPointsFilter::retainBest(keypoints, maxKeypoints);
-                    cout << " NOTE: Keypoints have been limited!" << endl;
-                }
-
-                // push keypoints and descriptor for current frame to end of data buffer
-                (dataBuffer.end() - 1)->keypoints = keypoints;
-                // cout << "#2 : DETECT KEYPOINTS done" << endl;
-
-                /* EXTRACT KEYPOINT DESCRIPTORS */
-                cv::Mat descriptors;
-                // string descriptorType = "BRISK"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                //string descriptorType = "BRIEF"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                // Check NOTE 1
-                //string descriptorType = "ORB"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                // string descriptorType = "FREAK"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                // Check NOTE 2
-                // string descriptorType = "AKAZE"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                // Check NOTE 3
-                // string descriptorType = "SIFT"; // BRIEF, ORB, FREAK, AKAZE, SIFT
-                keyTime += descKeypoints((dataBuffer.end() - 1)->keypoints, 
-                                        (dataBuffer.end() - 1)->cameraImg, 
-                                        descriptors, descriptorType);
-
-
-
-                // push descriptors for current frame to end of data buffer
-                (dataBuffer.end() - 1)->descriptors = descriptors;
-                // cout << "#3 : EXTRACT DESCRIPTORS done" << endl;
-
-                if (dataBuffer.size() > 1) // wait until at least two images have been processed
-                {
-
-                    /* MATCH KEYPOINT DESCRIPTORS */
-                    vector<cv::DMatch> matches;
-
-                    string matcherType = "MAT_BF"; // MAT_BF, MAT_FLANN
-                    //string matcherType = "MAT_FLANN";
-
-                    // string descriptorCategory = "DES_BINARY"; // DES_BINARY, DES_HOG
-                    // string descriptorCategory = "DES_HOG";
-                    string descriptorCategory;
-
-                    //if ( (descriptorType.compare("SIFT") == 0) || (descriptorType.compare("AKAZE") == 0) )
-                    if (descriptorType.compare("SIFT") == 0)
-                    {
-                        descriptorCategory = "DES_HOG";
-                    }
-                    else
-                    {
-                        descriptorCategory = "DES_BINARY";
-                    }
-                    
-                    // string selectorType = "SEL_NN"; // SEL_NN, SEL_KNN
-                    string selectorType = "SEL_KNN";
-
-                    matchDescriptors((dataBuffer.end() - 2)->keypoints, (dataBuffer.end() - 1)->keypoints,
-                                    (dataBuffer.end() - 2)->descriptors, (dataBuffer.end() - 1)->descriptors,
-                                    matches, descriptorCategory, matcherType, selectorType);
-
-
-                    // store matches in current data frame
-                    (dataBuffer.end() - 1)->kptMatches = matches;
-                    // cout << "#4 : MATCH KEYPOINT DESCRIPTORS done" << endl;
-
-                    if (bVis)
-                    {
-                        cv::Mat matchImg = ((dataBuffer.end() - 1)->cameraImg).clone();
-
-                        cv::drawMatches((dataBuffer.end() - 2)->cameraImg, (dataBuffer.end() - 2)->keypoints,
-                                        (dataBuffer.end() - 1)->cameraImg, (dataBuffer.end() - 1)->keypoints,
-                                        matches, matchImg,
-                                        cv::Scalar::all(-1), cv::Scalar::all(-1),
-                                        vector<char>(), cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
-                        string windowName = "Matching keypoints between two camera images";
-                        cv::namedWindow(windowName, 7);
-                        cv::imshow(windowName, matchImg);
-                        cout << "Press key to continue to next image" << endl;
-                        cv::waitKey(0); // wait for key to be pressed
-                    }
-                    std::cout << "----------" << std::endl;
-                    std::cout << "Detector: " << detectorType << std::endl;
-                    std::cout << "Descriptor: " << descriptorType << std::endl;
-                    std::cout << "Total Keypoints: " << keypoints.size() << std::endl;
-                    std::cout << "Matched Keypoints: " << matches.size() << std::endl;
-                    std::cout << "Detection + Description Time (ms): " << keyTime*1000 << std::endl;
-                    std::cout << "(Matching time not calculated/included)" << std::endl;
-                    std::cout << "==========" << std::endl;
-
-                    tenImgKptsNum.push_back(keypoints.size());
-                    tenImgMatchedKptsNum.push_back(matches.size());
-                    tenImgDetDescTime.push_back(keyTime*1000);
-                } // eof ensure dataBuffer size greater than 1
-            } // eof loop over all images
-            //Writing to file for plotting
-            // Cols (Descriptors): ["BRISK", "BRIEF", "ORB", "FREAK", "AKAZE", "SIFT"] (6)
-            // Rows (Detectors): ["SHITOMASI"; "HARRIS"; "FAST"; "BRISK"; "ORB"; "AKAZE"; "SIFT"] (7)
-            // 7x6 matrix
-            // Cell Entries: avgValues over 10 frames
-            if(!tenImgKptsNum.empty())
+                TrackingConfig config = baseConfig;
+                config.detectorType = detVec[row];
+                config.descriptorType = descVec[col];
+                CombinationResult *cell = &results[row][col];
+                pool.submit([config, cell, &frameCache]() {
+                    *cell = runCombination(config, frameCache);
+                    std::cout << (cell->bSkipped ? "Skipped " : "Done ") + config.detectorType + ", " + config.descriptorType + "\n";
+                });
+            }
+        }
+        pool.wait();
+    }
+    else
+    {
+        for (size_t row = 0; row < detVec.size(); ++row)
+        {
+            for (size_t col = 0; col < descVec.size(); ++col)
+            {
+                TrackingConfig config = baseConfig;
+                config.detectorType = detVec[row];
+                config.descriptorType = descVec[col];
+                results[row][col] = runCombination(config, frameCache);
+            }
+        }
+    }
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    std::cout << "Sweep finished in " << t << " s" << std::endl;
+
+    //Writing to file for plotting
+    // Cols (Descriptors): ["BRISK", "BRIEF", "ORB", "FREAK", "AKAZE", "SIFT"] (6)
+    // Rows (Detectors): ["SHITOMASI"; "HARRIS"; "FAST"; "BRISK"; "ORB"; "AKAZE"; "SIFT"] (7)
+    // 7x6 matrix
+    // Cell Entries: avgValues over 10 frames
+    // (opened only here: the single-combination modes above return early and must not truncate the tables)
+    std::ofstream outKptsNum(outputDir + "all_kpts_num.txt");
+    std::ofstream outKptsMatchedNum(outputDir + "all_kpts_matched_num.txt");
+    std::ofstream outDetDescTime(outputDir + "all_detdesc_time.txt");
+    for (const vector<CombinationResult> &row : results)
+    {
+        for (const CombinationResult &cell : row)
+        {
+            if (cell.bSkipped)
             {
-                outKptsNum << calcAvg(tenImgKptsNum) << ", ";
-                outKptsMatchedNum << calcAvg(tenImgMatchedKptsNum) << ", ";
-                outDetDescTime << calcAvg(tenImgDetDescTime) << ", ";            
+                outKptsNum << "NaN" << ", ";
+                outKptsMatchedNum << "NaN" << ", ";
+                outDetDescTime << "NaN" << ", ";
             }
-        } // eof loop over all descriptors
+            else
+            {
+                outKptsNum << cell.avgKptsNum << ", ";
+                outKptsMatchedNum << cell.avgMatchedKptsNum << ", ";
+                outDetDescTime << cell.avgDetDescTime << ", ";
+            }
+        }
         outKptsNum << "\n";
         outKptsMatchedNum << "\n";
-        outDetDescTime << "\n"; 
-    } // eof loop over all detectors
+        outDetDescTime << "\n";
+    }
 
     return 0;
 }
@@ -301,6 +562,8 @@ int main(int argc, const char *argv[])
 
 // NOTE 1:
 // When SIFT detector and ORB Descriptor are used. OUT OF MEMORY runtime error appears!!
+// (ORB builds one pyramid level per keypoint octave and SIFT packs octave/layer/scale into that field;
+//  detectFrame now remaps those octaves / trims the keypoints to the descriptor memory budget)
 // Is fine if both ORB detector and descriptor are used.
 /*
     root@42d94b09e2b4:/home/workspace/keypoint-detection/_build# ./2D_feature_tracking 
@@ -0,0 +1,105 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+
+#include "allocCounter.hpp"
+
+#if defined(__GLIBC__)
+
+namespace
+{
+std::atomic<size_t> numAllocations(0); // zero-initialized before any allocation can happen
+
+void countAllocation()
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+// glibc's implementations, which the definitions below forward to
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t num, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+extern "C" void *malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t num, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(num, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    countAllocation();
+    void *p = __libc_memalign(alignment, size);
+    if (!p)
+    {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void *valloc(size_t size)
+{
+    countAllocation();
+    return __libc_memalign(4096, size);
+}
+
+extern "C" void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+bool allocationCountSupported()
+{
+    return true;
+}
+
+size_t allocationCount()
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool allocationCountSupported()
+{
+    return false;
+}
+
+size_t allocationCount()
+{
+    return 0;
+}
+
+#endif
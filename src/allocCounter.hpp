@@ -0,0 +1,16 @@
+#ifndef allocCounter_hpp
+#define allocCounter_hpp
+
+#include <cstddef>
+
+
+// Counts the heap allocations of the whole process (all threads, OpenCV included) by interposing malloc and
+// friends, which operator new goes through as well. Only linked into the benchmark, where the difference of
+// allocationCount() around a stage gives its allocations. Needs glibc (the calls are forwarded to its
+// __libc_* entry points); elsewhere nothing is counted and allocationCountSupported() is false.
+bool allocationCountSupported();
+
+// no. of allocations (malloc, calloc, realloc, memalign, posix_memalign, aligned_alloc, valloc) so far
+size_t allocationCount();
+
+#endif /* allocCounter_hpp */
@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "benchStats.hpp"
+
+using namespace std;
+
+double percentile(vector<double> &samples, double p)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+    if (!is_sorted(samples.begin(), samples.end()))
+    {
+        sort(samples.begin(), samples.end());
+    }
+    size_t rank = (size_t)ceil(p / 100.0 * samples.size());
+    return samples[min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+LatencyStats computeLatencyStats(vector<double> samples)
+{
+    LatencyStats stats;
+    stats.count = samples.size();
+    if (samples.empty())
+    {
+        return stats;
+    }
+    sort(samples.begin(), samples.end());
+    stats.mean = accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.p50 = percentile(samples, 50.0);
+    stats.p95 = percentile(samples, 95.0);
+    stats.p99 = percentile(samples, 99.0);
+    stats.max = samples.back();
+    return stats;
+}
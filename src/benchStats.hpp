@@ -0,0 +1,24 @@
+#ifndef benchStats_hpp
+#define benchStats_hpp
+
+#include <cstddef>
+#include <vector>
+
+
+// summary of a set of latency samples (all values in ms)
+struct LatencyStats
+{
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// nearest-rank percentile of the samples, p in [0, 100]; samples are sorted in place
+double percentile(std::vector<double> &samples, double p);
+
+LatencyStats computeLatencyStats(std::vector<double> samples);
+
+#endif /* benchStats_hpp */
@@ -0,0 +1,589 @@
+/* BENCHMARK HARNESS FOR THE DETECTOR / DESCRIPTOR / MATCHER COMBINATIONS */
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "allocCounter.hpp"
+#include "benchStats.hpp"
+#include "dataFrameBuffer.hpp"
+#include "dataStructures.h"
+#include "featureTracking.hpp"
+#include "frameCache.hpp"
+
+using namespace std;
+
+namespace
+{
+const char *usage =
+    "usage: 2D_feature_benchmark [options]\n"
+    "  --det <list>        comma separated detectors   (default SHITOMASI,HARRIS,FAST,BRISK,ORB,AKAZE,SIFT)\n"
+    "  --desc <list>       comma separated descriptors (default BRISK,BRIEF,ORB,FREAK,AKAZE,SIFT)\n"
+    "  --matcher <list>    MAT_BF,MAT_FLANN            (default MAT_BF)\n"
+    "  --selector <list>   SEL_NN,SEL_KNN              (default SEL_KNN)\n"
+    "  --warmup <n>        untimed passes over the sequence per combination (default 1)\n"
+    "  --reps <n>          timed passes over the sequence per combination (default 5)\n"
+    "  --cached            load frames from the in-memory frame cache instead of decoding them\n"
+    "  --roi-detect        detect inside the padded vehicle ROI only\n"
+    "  --gated             motion-predicted, grid-gated matching\n"
+    "  --no-fused          detect and describe same-family pairs separately (detect includes describe otherwise)\n"
+    "  --budget <n>        at most n keypoints per ROI before description\n"
+    "  --budget-method <m> GRID, ANMS or BEST           (default GRID)\n"
+    "  --quantize          RootSIFT uint8 float descriptors, reports the match recall vs. float matching\n"
+    "  --verify [model]    geometric verification of the matches, HOMOGRAPHY or FUNDAMENTAL (default HOMOGRAPHY)\n"
+    "  --frame-cache <f>   memory-map the frames from this raw frame cache file (written on the first run)\n"
+    "  --data <path>       data location containing images/ (default ../)\n"
+    "  --json <file>       JSON output (default benchmark.json)\n"
+    "  --csv <file>        CSV output (default benchmark.csv)\n";
+
+const char *stageNames[] = {"load", "detect", "describe", "match", "verify", "total"};
+enum Stage { LOAD, DETECT, DESCRIBE, MATCH, VERIFY, TOTAL, NUM_STAGES };
+
+// one benchmarked configuration, i.e. one row of the output
+struct BenchResult
+{
+    string detectorType, descriptorType, matcherType, selectorType;
+    bool bSkipped = false;
+    size_t numFrames = 0;  // timed frames (reps x sequence length)
+    size_t numMatched = 0; // timed frames which were matched against a previous frame
+    double avgKeypoints = 0.0;
+    double avgMatches = 0.0;
+    double keypointsPerSec = 0.0; // keypoints / (detect + describe time)
+    double matchesPerSec = 0.0;   // matches / match time
+    double setupMs = 0.0;         // constructing the detector/descriptor instances, once per combination
+    LatencyStats stages[NUM_STAGES];
+    double allocsPerFrame[NUM_STAGES] = {0.0}; // mean heap allocations of the stage per timed frame (all threads)
+    size_t maxAllocsPerFrame = 0;              // worst timed frame, all stages
+    double recallVsFloat = -1.0; // quantized descriptors: share of the float matches found too, -1 if not evaluated
+    double inlierRatio = -1.0;   // geometric verification: share of the matches fitting the model, -1 if not verified
+    double budgetedDetectAllocs = -1.0; // detect allocations per frame with the keypoint budget on, -1 if not counted
+    double indexBuildsPerFrame = 0.0;   // matcher indices built per timed frame (0 for the SIMD kernels)
+    double indexHitsPerMatch = 0.0;     // matched frames whose reference index was reused instead of rebuilt
+};
+
+vector<string> splitList(const string &list)
+{
+    vector<string> items;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+double elapsedMs(double tStart)
+{
+    return ((double)cv::getTickCount() - tStart) / cv::getTickFrequency() * 1000.0;
+}
+
+// heap allocations per frame of the detect stage with the keypoint budget (config's or the default one) applied,
+// counted over a second pass of the cached frames after a first one has grown the slots and arenas
+double countBudgetedDetectAllocs(TrackingConfig config, FeaturePipeline &features, const FrameCache &frameCache)
+{
+    config.bLimitKpts = true;
+    DataFrameBuffer dataBuffer(2);
+    size_t numAllocs = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        dataBuffer.clear();
+        for (size_t imgIndex = 0; imgIndex < frameCache.size(); ++imgIndex)
+        {
+            DataFrame &currFrame = dataBuffer.push(frameCache.frame(imgIndex));
+            size_t a = allocationCount();
+            detectFrame(currFrame, config, features);
+            numAllocs += pass > 0 ? allocationCount() - a : 0;
+        }
+    }
+    return frameCache.size() > 0 ? (double)numAllocs / frameCache.size() : 0.0;
+}
+
+// runs the sequence warmup + reps times and collects per-frame stage latencies of the timed passes
+BenchResult benchmarkCombination(const TrackingConfig &config, const vector<string> &imgFilenames,
+                                 const FrameCache &frameCache, bool bCached, int numWarmup, int numReps)
+{
+    BenchResult result;
+    result.detectorType = config.detectorType;
+    result.descriptorType = config.descriptorType;
+    result.matcherType = config.matcherType;
+    result.selectorType = config.selectorType;
+    if (!isSupportedCombination(config.detectorType, config.descriptorType))
+    {
+        result.bSkipped = true;
+        return result;
+    }
+
+    // built once and reused by every pass, so construction is reported separately and not in any frame
+    FeaturePipeline features(config.detectorType, config.descriptorType, usesFusedDetDesc(config));
+    result.setupMs = features.setupTime() * 1000.0;
+
+    vector<double> samples[NUM_STAGES];
+    double sumKeypoints = 0.0, sumMatches = 0.0, sumDetDescMs = 0.0, sumMatchMs = 0.0;
+    size_t sumAllocs[NUM_STAGES] = {0};
+    double sumRecall = 0.0;
+    size_t numRecall = 0;
+    size_t sumInliers = 0, sumVerified = 0;
+    size_t sumIndexBuilds = 0, sumIndexHits = 0;
+    DataFrameBuffer dataBuffer(2); // slots are reused in place across passes, so the warmup grows their storage
+    for (int rep = 0; rep < numWarmup + numReps; ++rep)
+    {
+        bool bTimed = rep >= numWarmup;
+        dataBuffer.clear();
+        for (size_t imgIndex = 0; imgIndex < imgFilenames.size(); ++imgIndex)
+        {
+            double ms[NUM_STAGES] = {0.0};
+            size_t allocs[NUM_STAGES] = {0};
+
+            // load image from file and convert to grayscale (or take the cached frame)
+            size_t a = allocationCount();
+            double t = (double)cv::getTickCount();
+            cv::Mat imgGray;
+            if (bCached)
+            {
+                imgGray = frameCache.frame(imgIndex);
+            }
+            else
+            {
+                cv::Mat img = cv::imread(imgFilenames[imgIndex]);
+                cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+            }
+            DataFrame &currFrame = dataBuffer.push(imgGray);
+            bool bHavePrev = dataBuffer.size() > 1;
+            ms[LOAD] = elapsedMs(t);
+            allocs[LOAD] = allocationCount() - a;
+
+            a = allocationCount();
+            t = (double)cv::getTickCount();
+            detectFrame(currFrame, config, features);
+            ms[DETECT] = elapsedMs(t);
+            allocs[DETECT] = allocationCount() - a;
+
+            // the frame's matcher index is built with its description, like in the streaming pipeline, and
+            // queried by the next frame's match stage
+            size_t builds = matcherIndexBuilds(), hits = matcherIndexHits();
+            a = allocationCount();
+            t = (double)cv::getTickCount();
+            describeFrame(currFrame, config, features);
+            trainFrameMatcher(currFrame, config);
+            ms[DESCRIBE] = elapsedMs(t);
+            allocs[DESCRIBE] = allocationCount() - a;
+
+            if (bHavePrev)
+            {
+                a = allocationCount();
+                t = (double)cv::getTickCount();
+                matchFrames(dataBuffer.previous(), currFrame, config);
+                ms[MATCH] = elapsedMs(t);
+                allocs[MATCH] = allocationCount() - a;
+
+                a = allocationCount();
+                t = (double)cv::getTickCount();
+                verifyFrameMatches(dataBuffer.previous(), currFrame, config);
+                ms[VERIFY] = elapsedMs(t);
+                allocs[VERIFY] = allocationCount() - a;
+            }
+            ms[TOTAL] = ms[LOAD] + ms[DETECT] + ms[DESCRIBE] + ms[MATCH] + ms[VERIFY];
+            allocs[TOTAL] = allocs[LOAD] + allocs[DETECT] + allocs[DESCRIBE] + allocs[MATCH] + allocs[VERIFY];
+
+            if (bTimed)
+            {
+                for (int s = 0; s < NUM_STAGES; ++s)
+                {
+                    if ((s != MATCH && s != VERIFY) || bHavePrev)
+                    {
+                        samples[s].push_back(ms[s]);
+                    }
+                    sumAllocs[s] += allocs[s];
+                }
+                result.maxAllocsPerFrame = max(result.maxAllocsPerFrame, allocs[TOTAL]);
+                sumIndexBuilds += matcherIndexBuilds() - builds;
+                sumIndexHits += matcherIndexHits() - hits;
+                ++result.numFrames;
+                sumKeypoints += currFrame.keypoints.size();
+                sumDetDescMs += ms[DETECT] + ms[DESCRIBE];
+                if (bHavePrev)
+                {
+                    ++result.numMatched;
+                    sumMatches += currFrame.kptMatches.size();
+                    sumMatchMs += ms[MATCH];
+                    if (config.bVerifyMatches)
+                    {
+                        sumInliers += count(currFrame.kptMatchInliers.begin(), currFrame.kptMatchInliers.end(), 1);
+                        sumVerified += currFrame.kptMatchInliers.size();
+                    }
+
+                    DataFrame &prevFrame = dataBuffer.previous();
+                    if (currFrame.descriptors.depth() == CV_8U && unquantizedDescriptors(currFrame).depth() == CV_32F)
+                    {   // same matcher on the float rows, untimed
+                        vector<cv::DMatch> floatMatches;
+                        matchFramesReference(prevFrame, currFrame, unquantizedDescriptors(prevFrame),
+                                             unquantizedDescriptors(currFrame), config.matcherType, config, floatMatches);
+                        sumRecall += matchRecall(currFrame.kptMatches, floatMatches);
+                        ++numRecall;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int s = 0; s < NUM_STAGES; ++s)
+    {
+        result.stages[s] = computeLatencyStats(samples[s]);
+        result.allocsPerFrame[s] = result.numFrames > 0 ? (double)sumAllocs[s] / result.numFrames : 0.0;
+    }
+    result.avgKeypoints = result.numFrames > 0 ? sumKeypoints / result.numFrames : 0.0;
+    result.avgMatches = result.numMatched > 0 ? sumMatches / result.numMatched : 0.0;
+    result.keypointsPerSec = sumDetDescMs > 0.0 ? sumKeypoints / (sumDetDescMs / 1000.0) : 0.0;
+    result.matchesPerSec = sumMatchMs > 0.0 ? sumMatches / (sumMatchMs / 1000.0) : 0.0;
+    result.indexBuildsPerFrame = result.numFrames > 0 ? (double)sumIndexBuilds / result.numFrames : 0.0;
+    result.indexHitsPerMatch = result.numMatched > 0 ? (double)sumIndexHits / result.numMatched : 0.0;
+    if (numRecall > 0)
+    {
+        result.recallVsFloat = sumRecall / numRecall;
+    }
+    if (config.bVerifyMatches)
+    {
+        result.inlierRatio = sumVerified > 0 ? (double)sumInliers / sumVerified : 0.0;
+    }
+    if (allocationCountSupported())
+    {   // the budget runs in the detect stage; an unbudgeted run counts a budgeted detect pass on top
+        result.budgetedDetectAllocs = config.bLimitKpts ? result.allocsPerFrame[DETECT]
+                                                        : countBudgetedDetectAllocs(config, features, frameCache);
+    }
+    return result;
+}
+
+void writeJson(ostream &out, const vector<BenchResult> &results, int numWarmup, int numReps)
+{
+    out << "{\n  \"warmup\": " << numWarmup << ",\n  \"repetitions\": " << numReps
+        << ",\n  \"allocations_counted\": " << (allocationCountSupported() ? "true" : "false") << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        out << (i > 0 ? "," : "") << "\n    {\"detector\": \"" << r.detectorType << "\", \"descriptor\": \"" << r.descriptorType
+            << "\", \"matcher\": \"" << r.matcherType << "\", \"selector\": \"" << r.selectorType << "\", ";
+        if (r.bSkipped)
+        {
+            out << "\"skipped\": true}";
+            continue;
+        }
+        out << "\"skipped\": false, \"frames\": " << r.numFrames << ", \"keypoints_per_frame\": " << r.avgKeypoints
+            << ", \"matches_per_frame\": " << r.avgMatches << ", \"keypoints_per_sec\": " << r.keypointsPerSec
+            << ", \"matches_per_sec\": " << r.matchesPerSec << ", \"setup_ms\": " << r.setupMs
+            << ", \"index_builds_per_frame\": " << r.indexBuildsPerFrame << ", \"index_hits_per_match\": " << r.indexHitsPerMatch
+            << ",\n     \"latency_ms\": {";
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            const LatencyStats &l = r.stages[s];
+            out << (s > 0 ? ", " : "") << "\"" << stageNames[s] << "\": {\"mean\": " << l.mean << ", \"p50\": " << l.p50
+                << ", \"p95\": " << l.p95 << ", \"p99\": " << l.p99 << ", \"max\": " << l.max << "}";
+        }
+        out << "},\n     \"allocs_per_frame\": {";
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            out << (s > 0 ? ", " : "") << "\"" << stageNames[s] << "\": " << r.allocsPerFrame[s];
+        }
+        out << "}, \"max_allocs_per_frame\": " << r.maxAllocsPerFrame << ", \"budgeted_detect_allocs_per_frame\": ";
+        if (r.budgetedDetectAllocs >= 0.0)
+        {
+            out << r.budgetedDetectAllocs;
+        }
+        else
+        {
+            out << "null";
+        }
+        out << ", \"recall_vs_float\": ";
+        if (r.recallVsFloat >= 0.0)
+        {
+            out << r.recallVsFloat;
+        }
+        else
+        {
+            out << "null";
+        }
+        out << ", \"inlier_ratio\": ";
+        if (r.inlierRatio >= 0.0)
+        {
+            out << r.inlierRatio << "}";
+        }
+        else
+        {
+            out << "null}";
+        }
+    }
+    out << "\n  ]\n}\n";
+}
+
+void writeCsv(ostream &out, const vector<BenchResult> &results)
+{
+    out << "detector,descriptor,matcher,selector,frames,keypoints_per_frame,matches_per_frame,keypoints_per_sec,matches_per_sec,setup_ms,"
+           "index_builds_per_frame,index_hits_per_match";
+    for (int s = 0; s < NUM_STAGES; ++s)
+    {
+        for (const char *stat : {"mean", "p50", "p95", "p99", "max"})
+        {
+            out << "," << stageNames[s] << "_" << stat << "_ms";
+        }
+    }
+    for (int s = 0; s < NUM_STAGES; ++s)
+    {
+        out << "," << stageNames[s] << "_allocs";
+    }
+    out << ",max_allocs,budgeted_detect_allocs,recall_vs_float,inlier_ratio\n";
+    for (const BenchResult &r : results)
+    {
+        out << r.detectorType << "," << r.descriptorType << "," << r.matcherType << "," << r.selectorType;
+        if (r.bSkipped)
+        {
+            out << ",NaN,NaN,NaN,NaN,NaN,NaN,NaN,NaN";
+            for (int i = 0; i < NUM_STAGES * 6 + 4; ++i)
+            {
+                out << ",NaN";
+            }
+            out << "\n";
+            continue;
+        }
+        out << "," << r.numFrames << "," << r.avgKeypoints << "," << r.avgMatches << "," << r.keypointsPerSec << "," << r.matchesPerSec << "," << r.setupMs
+            << "," << r.indexBuildsPerFrame << "," << r.indexHitsPerMatch;
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            const LatencyStats &l = r.stages[s];
+            out << "," << l.mean << "," << l.p50 << "," << l.p95 << "," << l.p99 << "," << l.max;
+        }
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            out << "," << r.allocsPerFrame[s];
+        }
+        out << "," << r.maxAllocsPerFrame << ",";
+        if (r.budgetedDetectAllocs >= 0.0)
+        {
+            out << r.budgetedDetectAllocs << ",";
+        }
+        else
+        {
+            out << "NaN,";
+        }
+        if (r.recallVsFloat >= 0.0)
+        {
+            out << r.recallVsFloat << ",";
+        }
+        else
+        {
+            out << "NaN,";
+        }
+        if (r.inlierRatio >= 0.0)
+        {
+            out << r.inlierRatio << "\n";
+        }
+        else
+        {
+            out << "NaN\n";
+        }
+    }
+}
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    vector<string> detVec = {"SHITOMASI", "HARRIS", "FAST", "BRISK", "ORB", "AKAZE", "SIFT"};
+    vector<string> descVec = {"BRISK", "BRIEF", "ORB", "FREAK", "AKAZE", "SIFT"};
+    vector<string> matcherVec = {"MAT_BF"};
+    vector<string> selectorVec = {"SEL_KNN"};
+    int numWarmup = 1, numReps = 5;
+    bool bCached = false;
+    string dataPath = "../";
+    string rawFrameCache; // empty = decode the PNGs into memory
+    string jsonFile = "benchmark.json", csvFile = "benchmark.csv";
+
+    TrackingConfig baseConfig;
+    baseConfig.bVerbose = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool bHasValue = i + 1 < argc;
+        if (arg == "--det" && bHasValue)
+        {
+            detVec = splitList(argv[++i]);
+        }
+        else if (arg == "--desc" && bHasValue)
+        {
+            descVec = splitList(argv[++i]);
+        }
+        else if (arg == "--matcher" && bHasValue)
+        {
+            matcherVec = splitList(argv[++i]);
+        }
+        else if (arg == "--selector" && bHasValue)
+        {
+            selectorVec = splitList(argv[++i]);
+        }
+        else if (arg == "--warmup" && bHasValue)
+        {
+            numWarmup = atoi(argv[++i]);
+        }
+        else if (arg == "--reps" && bHasValue)
+        {
+            numReps = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--cached")
+        {
+            bCached = true;
+        }
+        else if (arg == "--roi-detect")
+        {
+            baseConfig.bDetectInRoi = true;
+        }
+        else if (arg == "--gated")
+        {
+            baseConfig.bGatedMatching = true;
+        }
+        else if (arg == "--no-fused")
+        {
+            baseConfig.bFusedDetDesc = false;
+        }
+        else if (arg == "--budget" && bHasValue)
+        {
+            baseConfig.bLimitKpts = true;
+            baseConfig.budget.maxKeypoints = atoi(argv[++i]);
+        }
+        else if (arg == "--budget-method" && bHasValue)
+        {
+            baseConfig.budget.method = parseBudgetMethod(argv[++i]);
+            if (baseConfig.budget.method == BUDGET_INVALID)
+            {
+                cout << "--budget-method: must be GRID, ANMS or BEST, got " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--quantize")
+        {
+            baseConfig.bQuantizeFloat = true;
+        }
+        else if (arg == "--verify")
+        {
+            baseConfig.bVerifyMatches = true;
+            if (bHasValue && argv[i + 1][0] != '-')
+            {
+                baseConfig.verifyParams.model = argv[++i];
+            }
+            if (!isVerifyModel(baseConfig.verifyParams.model))
+            {
+                cout << "--verify: model must be HOMOGRAPHY or FUNDAMENTAL, got " << baseConfig.verifyParams.model << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--frame-cache" && bHasValue)
+        {
+            rawFrameCache = argv[++i];
+        }
+        else if (arg == "--data" && bHasValue)
+        {
+            dataPath = argv[++i];
+        }
+        else if (arg == "--json" && bHasValue)
+        {
+            jsonFile = argv[++i];
+        }
+        else if (arg == "--csv" && bHasValue)
+        {
+            csvFile = argv[++i];
+        }
+        else
+        {
+            cout << usage;
+            return 1;
+        }
+    }
+
+    // same sequence as the main program
+    string imgBasePath = dataPath + "images/";
+    string imgPrefix = "KITTI/2011_09_26/image_00/data/000000";
+    string imgFileType = ".png";
+    int imgStartIndex = 0, imgEndIndex = 9, imgFillWidth = 4;
+    vector<string> imgFilenames;
+    for (int imgIndex = imgStartIndex; imgIndex <= imgEndIndex; imgIndex++)
+    {
+        ostringstream imgNumber;
+        imgNumber << setfill('0') << setw(imgFillWidth) << imgIndex;
+        imgFilenames.push_back(imgBasePath + imgPrefix + imgNumber.str() + imgFileType);
+    }
+    FrameCache frameCache;
+    if (!frameCache.load(imgFilenames, rawFrameCache))
+    {
+        return 1;
+    }
+
+    vector<BenchResult> results;
+    for (const string &detectorType : detVec)
+    {
+        for (const string &descriptorType : descVec)
+        {
+            for (const string &matcherType : matcherVec)
+            {
+                for (const string &selectorType : selectorVec)
+                {
+                    TrackingConfig config = baseConfig;
+                    config.detectorType = detectorType;
+                    config.descriptorType = descriptorType;
+                    config.matcherType = matcherType;
+                    config.selectorType = selectorType;
+
+                    BenchResult r = benchmarkCombination(config, imgFilenames, frameCache, bCached, numWarmup, numReps);
+                    cout << setw(10) << detectorType << setw(7) << descriptorType << setw(10) << matcherType << setw(8) << selectorType;
+                    if (r.bSkipped)
+                    {
+                        cout << "  skipped" << endl;
+                    }
+                    else
+                    {
+                        const LatencyStats &total = r.stages[TOTAL];
+                        cout << fixed << setprecision(2) << "  total p50 " << setw(8) << total.p50 << " ms, p99 " << setw(8)
+                             << total.p99 << " ms, max " << setw(8) << total.max << " ms, " << setprecision(0) << setw(6)
+                             << r.avgKeypoints << " kpts, " << setw(5) << r.avgMatches << " matches";
+                        if (allocationCountSupported())
+                        {
+                            cout << ", " << setprecision(1) << setw(7) << r.allocsPerFrame[TOTAL] << " allocs/frame ("
+                                 << r.budgetedDetectAllocs << " budgeted detect)";
+                        }
+                        if (r.indexBuildsPerFrame > 0.0)
+                        {
+                            cout << ", " << setprecision(2) << r.indexBuildsPerFrame << " index builds/frame, "
+                                 << r.indexHitsPerMatch << " reused/match";
+                        }
+                        if (r.recallVsFloat >= 0.0)
+                        {
+                            cout << ", recall vs. float " << setprecision(1) << r.recallVsFloat * 100 << " %";
+                        }
+                        if (r.inlierRatio >= 0.0)
+                        {
+                            cout << ", verify p50 " << setprecision(2) << r.stages[VERIFY].p50 << " ms, "
+                                 << setprecision(1) << r.inlierRatio * 100 << " % inliers";
+                        }
+                        cout << defaultfloat << endl;
+                    }
+                    results.push_back(r);
+                }
+            }
+        }
+    }
+
+    ofstream jsonOut(jsonFile);
+    writeJson(jsonOut, results, numWarmup, numReps);
+    ofstream csvOut(csvFile);
+    writeCsv(csvOut, results);
+    cout << "Results written to " << jsonFile << " and " << csvFile << endl;
+    return 0;
+}
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <opencv2/imgproc.hpp>
+
+#include "cornerDetector.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CORNER_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+// row kernels: everything between the gradients and the response map works on contiguous float rows
+struct CornerKernels
+{
+    // xx = gx * gx, xy = gx * gy, yy = gy * gy
+    void (*products)(const float *gx, const float *gy, float *xx, float *xy, float *yy, int n);
+    // acc += src
+    void (*addRow)(float *acc, const float *src, int n);
+    // response of the box-summed structure tensor, returns the row maximum
+    float (*response)(const float *sxx, const float *sxy, const float *syy, float *out, int n, float k);
+};
+
+void productsScalar(const float *gx, const float *gy, float *xx, float *xy, float *yy, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        xx[i] = gx[i] * gx[i];
+        xy[i] = gx[i] * gy[i];
+        yy[i] = gy[i] * gy[i];
+    }
+}
+
+void addRowScalar(float *acc, const float *src, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        acc[i] += src[i];
+    }
+}
+
+// same formulation as cv::cornerMinEigenVal
+float minEigenScalar(const float *sxx, const float *sxy, const float *syy, float *out, int n, float)
+{
+    float rowMax = 0.0f;
+    for (int i = 0; i < n; ++i)
+    {
+        float a = sxx[i] * 0.5f, b = sxy[i], c = syy[i] * 0.5f;
+        out[i] = (a + c) - sqrt((a - c) * (a - c) + b * b);
+        rowMax = max(rowMax, out[i]);
+    }
+    return rowMax;
+}
+
+// same formulation as cv::cornerHarris
+float harrisScalar(const float *sxx, const float *sxy, const float *syy, float *out, int n, float k)
+{
+    float rowMax = 0.0f;
+    for (int i = 0; i < n; ++i)
+    {
+        float a = sxx[i], b = sxy[i], c = syy[i];
+        out[i] = a * c - b * b - k * (a + c) * (a + c);
+        rowMax = max(rowMax, out[i]);
+    }
+    return rowMax;
+}
+
+#ifdef CORNER_X86
+__attribute__((target("avx2"))) float horizontalMaxAvx2(__m256 v)
+{
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+__attribute__((target("avx2"))) void productsAvx2(const float *gx, const float *gy, float *xx, float *xy, float *yy, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(gx + i), y = _mm256_loadu_ps(gy + i);
+        _mm256_storeu_ps(xx + i, _mm256_mul_ps(x, x));
+        _mm256_storeu_ps(xy + i, _mm256_mul_ps(x, y));
+        _mm256_storeu_ps(yy + i, _mm256_mul_ps(y, y));
+    }
+    productsScalar(gx + i, gy + i, xx + i, xy + i, yy + i, n - i);
+}
+
+__attribute__((target("avx2"))) void addRowAvx2(float *acc, const float *src, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(src + i)));
+    }
+    addRowScalar(acc + i, src + i, n - i);
+}
+
+__attribute__((target("avx2"))) float minEigenAvx2(const float *sxx, const float *sxy, const float *syy, float *out, int n, float k)
+{
+    const __m256 half = _mm256_set1_ps(0.5f);
+    __m256 rowMax = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(sxx + i), half);
+        __m256 b = _mm256_loadu_ps(sxy + i);
+        __m256 c = _mm256_mul_ps(_mm256_loadu_ps(syy + i), half);
+        __m256 d = _mm256_sub_ps(a, c);
+        __m256 root = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(d, d), _mm256_mul_ps(b, b)));
+        __m256 r = _mm256_sub_ps(_mm256_add_ps(a, c), root);
+        _mm256_storeu_ps(out + i, r);
+        rowMax = _mm256_max_ps(rowMax, r);
+    }
+    return max(horizontalMaxAvx2(rowMax), minEigenScalar(sxx + i, sxy + i, syy + i, out + i, n - i, k));
+}
+
+__attribute__((target("avx2"))) float harrisAvx2(const float *sxx, const float *sxy, const float *syy, float *out, int n, float k)
+{
+    const __m256 kv = _mm256_set1_ps(k);
+    __m256 rowMax = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(sxx + i), b = _mm256_loadu_ps(sxy + i), c = _mm256_loadu_ps(syy + i);
+        __m256 trace = _mm256_add_ps(a, c);
+        __m256 det = _mm256_sub_ps(_mm256_mul_ps(a, c), _mm256_mul_ps(b, b));
+        __m256 r = _mm256_sub_ps(det, _mm256_mul_ps(kv, _mm256_mul_ps(trace, trace)));
+        _mm256_storeu_ps(out + i, r);
+        rowMax = _mm256_max_ps(rowMax, r);
+    }
+    return max(horizontalMaxAvx2(rowMax), harrisScalar(sxx + i, sxy + i, syy + i, out + i, n - i, k));
+}
+#endif /* CORNER_X86 */
+
+CornerKernels selectKernels(bool bHarris)
+{
+    CornerKernels kernels = {productsScalar, addRowScalar, bHarris ? harrisScalar : minEigenScalar};
+#ifdef CORNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.products = productsAvx2;
+        kernels.addRow = addRowAvx2;
+        kernels.response = bHarris ? harrisAvx2 : minEigenAvx2;
+    }
+#endif
+    return kernels;
+}
+
+// BORDER_REFLECT_101, which is what cv::cornerMinEigenVal / cv::cornerHarris use
+inline int reflect101(int i, int n)
+{
+    if (n == 1)
+    {
+        return 0;
+    }
+    i = i < 0 ? -i : i;
+    i = i >= n ? 2 * n - 2 - i : i;
+    return min(n - 1, max(0, i));
+}
+
+struct TileScratch
+{
+    vector<int> colIdx;
+    vector<float> gx, gy, xx, xy, yy; // gradients and products over the tile plus the tensor window
+    vector<float> hxx, hxy, hyy;      // horizontally box-summed products
+    vector<float> sxx, sxy, syy;      // one row of the structure tensor
+};
+
+// Response of the pixels [x0, x1) x [y0, y1) into resp (row stride in floats). Gradients are computed on the
+// tile extended by the tensor window, reading image pixels of the neighbouring tiles. Returns the tile maximum.
+float tileResponse(const cv::Mat &img, int x0, int y0, int x1, int y1, float *resp, size_t respStride,
+                   const CornerParams &params, const CornerKernels &kernels, TileScratch &s)
+{
+    const int bs = params.blockSize, bLo = bs / 2; // window [x - bs/2, x + bs - 1 - bs/2] as in cv::boxFilter
+    const int tw = x1 - x0, th = y1 - y0, pw = tw + bs - 1, ph = th + bs - 1;
+    const int px0 = x0 - bLo, py0 = y0 - bLo;
+    const float scale = 1.0f / (4.0f * bs * 255.0f); // Sobel 3x3 scale of cv::cornerMinEigenVal for 8 bit input
+    const float k = (float)params.k;
+
+    s.colIdx.resize(pw + 2);
+    for (int j = 0; j < pw + 2; ++j)
+    {
+        s.colIdx[j] = reflect101(px0 + j - 1, img.cols);
+    }
+    size_t planeSize = (size_t)pw * ph;
+    s.gx.resize(pw);
+    s.gy.resize(pw);
+    s.xx.resize(planeSize);
+    s.xy.resize(planeSize);
+    s.yy.resize(planeSize);
+
+    // Sobel gradients and their products, one row of the extended tile at a time
+    for (int r = 0; r < ph; ++r)
+    {
+        int y = py0 + r;
+        const uchar *up = img.ptr<uchar>(reflect101(y - 1, img.rows));
+        const uchar *mid = img.ptr<uchar>(reflect101(y, img.rows));
+        const uchar *dn = img.ptr<uchar>(reflect101(y + 1, img.rows));
+        const int *cols = s.colIdx.data();
+        for (int j = 0; j < pw; ++j)
+        {
+            int cL = cols[j], cC = cols[j + 1], cR = cols[j + 2];
+            int dx = (up[cR] - up[cL]) + 2 * (mid[cR] - mid[cL]) + (dn[cR] - dn[cL]);
+            int dy = (dn[cL] + 2 * dn[cC] + dn[cR]) - (up[cL] + 2 * up[cC] + up[cR]);
+            s.gx[j] = dx * scale;
+            s.gy[j] = dy * scale;
+        }
+        size_t off = (size_t)r * pw;
+        kernels.products(s.gx.data(), s.gy.data(), &s.xx[off], &s.xy[off], &s.yy[off], pw);
+    }
+
+    // box sums: horizontally as bs shifted row additions, then vertically over bs rows
+    size_t hSize = (size_t)tw * ph;
+    s.hxx.assign(hSize, 0.0f);
+    s.hxy.assign(hSize, 0.0f);
+    s.hyy.assign(hSize, 0.0f);
+    for (int r = 0; r < ph; ++r)
+    {
+        size_t src = (size_t)r * pw, dst = (size_t)r * tw;
+        for (int d = 0; d < bs; ++d)
+        {
+            kernels.addRow(&s.hxx[dst], &s.xx[src + d], tw);
+            kernels.addRow(&s.hxy[dst], &s.xy[src + d], tw);
+            kernels.addRow(&s.hyy[dst], &s.yy[src + d], tw);
+        }
+    }
+
+    float tileMax = 0.0f;
+    for (int y = 0; y < th; ++y)
+    {
+        s.sxx.assign(tw, 0.0f);
+        s.sxy.assign(tw, 0.0f);
+        s.syy.assign(tw, 0.0f);
+        for (int d = 0; d < bs; ++d)
+        {
+            size_t src = (size_t)(y + d) * tw;
+            kernels.addRow(s.sxx.data(), &s.hxx[src], tw);
+            kernels.addRow(s.sxy.data(), &s.hxy[src], tw);
+            kernels.addRow(s.syy.data(), &s.hyy[src], tw);
+        }
+        float *out = resp + (size_t)(y0 + y) * respStride + x0;
+        tileMax = max(tileMax, kernels.response(s.sxx.data(), s.sxy.data(), s.syy.data(), out, tw, k));
+    }
+    return tileMax;
+}
+
+// Corners of the tile [x0, x1) x [y0, y1): responses above the threshold which are the strongest within the
+// suppression radius. The window reaches into the neighbouring tiles; ties go to the earlier pixel in raster
+// order, so exactly one of two equal neighbours survives no matter which tile each belongs to.
+void tileMaxima(const float *resp, size_t respStride, int cols, int rows, int x0, int y0, int x1, int y1,
+                float threshold, int radius, float size, vector<cv::KeyPoint> &corners)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        const float *row = resp + (size_t)y * respStride;
+        for (int x = x0; x < x1; ++x)
+        {
+            float v = row[x];
+            if (v <= threshold)
+            {
+                continue;
+            }
+            bool bMax = true;
+            for (int wy = max(0, y - radius); wy <= min(rows - 1, y + radius) && bMax; ++wy)
+            {
+                const float *wRow = resp + (size_t)wy * respStride;
+                for (int wx = max(0, x - radius); wx <= min(cols - 1, x + radius); ++wx)
+                {
+                    float w = wRow[wx];
+                    if (w > v || (w == v && (wy < y || (wy == y && wx < x))))
+                    {
+                        bMax = false;
+                        break;
+                    }
+                }
+            }
+            if (bMax)
+            {
+                corners.push_back(cv::KeyPoint(cv::Point2f((float)x, (float)y), size, -1, v));
+            }
+        }
+    }
+}
+
+bool strongerResponse(const cv::KeyPoint &a, const cv::KeyPoint &b)
+{
+    return a.response > b.response;
+}
+} // namespace
+
+void CornerDetector::detect(vector<cv::KeyPoint> &keypoints, const cv::Mat &img)
+{
+    cv::Mat gray = img;
+    if (img.channels() != 1)
+    {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    if (gray.empty() || gray.depth() != CV_8U || params.blockSize < 1)
+    {
+        return;
+    }
+
+    static const CornerKernels minEigenKernels = selectKernels(false);
+    static const CornerKernels harrisKernels = selectKernels(true);
+    const CornerKernels &kernels = params.bHarris ? harrisKernels : minEigenKernels;
+
+    const int tileSize = max(8, params.tileSize);
+    const int tilesX = (gray.cols + tileSize - 1) / tileSize, tilesY = (gray.rows + tileSize - 1) / tileSize;
+    const int numTiles = tilesX * tilesY;
+    auto tileRect = [&](int tile) {
+        int x0 = (tile % tilesX) * tileSize, y0 = (tile / tilesX) * tileSize;
+        return cv::Rect(x0, y0, min(tileSize, gray.cols - x0), min(tileSize, gray.rows - y0));
+    };
+
+    // pass 1: response map and per-tile maxima
+    response.create(gray.rows, gray.cols, CV_32F);
+    float *resp = response.ptr<float>(0);
+    size_t respStride = response.step / sizeof(float);
+    tileMax.assign(numTiles, 0.0f);
+    cv::parallel_for_(cv::Range(0, numTiles), [&](const cv::Range &range) {
+        static thread_local TileScratch scratch; // grown once per worker thread, then reused
+        for (int tile = range.start; tile < range.end; ++tile)
+        {
+            cv::Rect r = tileRect(tile);
+            tileMax[tile] = tileResponse(gray, r.x, r.y, r.x + r.width, r.y + r.height, resp, respStride, params,
+                                         kernels, scratch);
+        }
+    });
+
+    // pass 2: global quality threshold, NMS per tile with halo, per-tile quota
+    float threshold = (float)params.qualityLevel * *max_element(tileMax.begin(), tileMax.end());
+    int radius = max(1, (int)ceil(params.minDistance) - 1);
+    tileCorners.resize(numTiles);
+    cv::parallel_for_(cv::Range(0, numTiles), [&](const cv::Range &range) {
+        for (int tile = range.start; tile < range.end; ++tile)
+        {
+            cv::Rect r = tileRect(tile);
+            vector<cv::KeyPoint> &corners = tileCorners[tile];
+            corners.clear();
+            tileMaxima(resp, respStride, gray.cols, gray.rows, r.x, r.y, r.x + r.width, r.y + r.height, threshold,
+                       radius, (float)params.blockSize, corners);
+            if (params.maxPerTile > 0 && (int)corners.size() > params.maxPerTile)
+            {
+                nth_element(corners.begin(), corners.begin() + params.maxPerTile, corners.end(), strongerResponse);
+                corners.resize(params.maxPerTile);
+            }
+        }
+    });
+
+    // merge in tile order, then strongest first like cv::goodFeaturesToTrack
+    size_t first = keypoints.size();
+    for (const vector<cv::KeyPoint> &corners : tileCorners)
+    {
+        keypoints.insert(keypoints.end(), corners.begin(), corners.end());
+    }
+    stable_sort(keypoints.begin() + first, keypoints.end(), strongerResponse);
+    if (params.maxCorners > 0 && keypoints.size() - first > (size_t)params.maxCorners)
+    {
+        keypoints.resize(first + params.maxCorners);
+    }
+}
+
+void detectCorners(vector<cv::KeyPoint> &keypoints, const cv::Mat &img, const CornerParams &params)
+{
+    CornerDetector detector(params);
+    detector.detect(keypoints, img);
+}
@@ -0,0 +1,50 @@
+#ifndef cornerDetector_hpp
+#define cornerDetector_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+
+// Tiled Shi-Tomasi / Harris corner detector, replacing cv::goodFeaturesToTrack for the traditional detectors.
+// The image is split into tiles which are processed in parallel (cv::parallel_for_, so balanceThreads applies):
+// each tile computes gradients, structure tensor and response for its pixels with AVX2 row kernels (scalar
+// fallback), then after one barrier for the global quality threshold every tile runs non-maximum suppression,
+// reading the responses of its neighbours across the tile border (halo). There is no global sort of all
+// candidates and no sequential min-distance pass; the per-tile results are merged under an optional quota.
+struct CornerParams
+{
+    bool bHarris = false;        // Harris response instead of the minimal eigenvalue (Shi-Tomasi)
+    int blockSize = 4;           // window of the structure tensor
+    double k = 0.04;             // Harris free parameter
+    double qualityLevel = 0.01;  // corners weaker than qualityLevel x strongest response are rejected
+    double minDistance = 4.0;    // a corner is the strongest response within this distance
+    int tileSize = 64;           // tile edge in pixels (the scratch of one tile stays in L2)
+    int maxPerTile = 0;          // keep at most this many corners per tile (strongest first), 0 = no quota
+    int maxCorners = 0;          // cap of the merged result, 0 = no cap
+};
+
+// Keeps the response map and per-tile results between frames, so detecting in a sequence of equally sized
+// images does not allocate (the per-thread tile scratch is retained as well).
+class CornerDetector
+{
+public:
+    explicit CornerDetector(const CornerParams &params = CornerParams()) : params(params) {}
+
+    // Corners sorted by descending response, with KeyPoint::response set (and size = blockSize), so
+    // retainBest / the keypoint budget can rank them.
+    void detect(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img);
+
+    // takes effect with the next detect (the adaptive threshold of FeaturePipeline)
+    void setQualityLevel(double qualityLevel) { params.qualityLevel = qualityLevel; }
+
+private:
+    CornerParams params;
+    cv::Mat response;
+    std::vector<float> tileMax;
+    std::vector<std::vector<cv::KeyPoint>> tileCorners;
+};
+
+// one-off detection with a temporary CornerDetector
+void detectCorners(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, const CornerParams &params);
+
+#endif /* cornerDetector_hpp */
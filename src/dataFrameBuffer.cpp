@@ -0,0 +1,41 @@
+#include <algorithm>
+
+#include "dataFrameBuffer.hpp"
+
+using namespace std;
+
+DataFrameBuffer::DataFrameBuffer(size_t capacity) : slots(max<size_t>(1, capacity))
+{
+}
+
+DataFrame &DataFrameBuffer::push(const cv::Mat &cameraImg)
+{
+    head = count == 0 ? 0 : (head + 1) % slots.size();
+    count = min(count + 1, slots.size());
+
+    DataFrame &slot = slots[head];
+    resetFrame(slot, cameraImg);
+    return slot;
+}
+
+DataFrame &DataFrameBuffer::frame(size_t age)
+{
+    return slots[(head + slots.size() - age % slots.size()) % slots.size()];
+}
+
+void resetFrame(DataFrame &frame, const cv::Mat &cameraImg)
+{
+    frame.cameraImg = cameraImg;
+    frame.keypoints.clear();
+    frame.numDetected = 0;
+    frame.kptMatches.clear();
+    frame.kptMatchInliers.clear();
+    frame.kptMatchesMultiRef.clear();
+    frame.kptFlow.clear();
+    frame.descriptors = cv::Mat(); // the rows stay allocated in descriptorStorage
+    // the index belongs to the overwritten frame
+    frame.matcher.release();
+    frame.matcherKey.clear();
+    frame.featureMapping.reset();
+    frame.scratch.reset(); // the previous frame's intermediates are done with
+}
@@ -0,0 +1,44 @@
+#ifndef dataFrameBuffer_hpp
+#define dataFrameBuffer_hpp
+
+#include <cstddef>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+
+// Fixed-capacity ring buffer of DataFrame slots. Pushing a frame into a full buffer overwrites the oldest slot
+// in place: its keypoint, match and flow vectors are cleared but keep their capacity, its descriptor rows
+// live in storage that only grows (see reuseRows) and its scratch arena is reset, so once the slots
+// have seen the largest frame of a sequence, running the buffer does not allocate.
+// Frames are addressed by age: 0 = current, 1 = previous, ...
+class DataFrameBuffer
+{
+public:
+    explicit DataFrameBuffer(size_t capacity);
+
+    // The next slot becomes the current frame, holding cameraImg and otherwise empty
+    DataFrame &push(const cv::Mat &cameraImg);
+
+    DataFrame &current() { return frame(0); }
+    DataFrame &previous() { return frame(1); }
+    DataFrame &frame(size_t age); // age < size()
+
+    // forget all frames (e.g. at the start of a new sequence), the slots keep their storage
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<DataFrame> slots;
+    size_t head = 0; // slot of the current frame
+    size_t count = 0;
+};
+
+// Makes frame hold cameraImg and otherwise nothing, keeping the capacity of its vectors, its descriptor storage
+// and its arena (what push does to the slot it reuses; the streaming pipeline recycles its frames the same way)
+void resetFrame(DataFrame &frame, const cv::Mat &cameraImg);
+
+#endif /* dataFrameBuffer_hpp */
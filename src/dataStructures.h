@@ -1,8 +1,13 @@
 #ifndef dataStructures_h
 #define dataStructures_h
 
+#include <memory>
+#include <string>
 #include <vector>
 #include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include "frameArena.hpp"
 
 
 struct DataFrame { // represents the available sensor information at the same time instance
@@ -10,8 +15,19 @@ struct DataFrame { // represents the available sensor information at the same ti
     cv::Mat cameraImg; // camera image
     
     std::vector<cv::KeyPoint> keypoints; // 2D keypoints within camera image
+    int numDetected = 0; // keypoints the detector found in the regions of interest, before the keypoint budget
     cv::Mat descriptors; // keypoint descriptors
+    cv::Mat descriptorStorage; // rows backing descriptors when the frame lives in a reused DataFrameBuffer slot
     std::vector<cv::DMatch> kptMatches; // keypoint matches between previous and current frame
+    std::vector<uchar> kptMatchInliers; // geometric verification: 1 if kptMatches[i] fits the model (empty if not verified)
+    std::vector<cv::DMatch> kptMatchesMultiRef; // best match of each keypoint over the last K frames (imgIdx = age of the frame)
+    std::vector<cv::Point2f> kptFlow; // displacement of each keypoint since the previous frame (NaN if unmatched)
+
+    cv::Ptr<cv::DescriptorMatcher> matcher; // matcher/index trained on this frame's descriptors, built once and reused
+    std::string matcherKey; // configuration the matcher was built for (empty if none)
+    std::shared_ptr<void> featureMapping; // memory-mapped FeatureStore file the descriptors point into (if loaded)
+
+    FrameArena scratch; // intermediates of the stages working on this frame
 };
 
 
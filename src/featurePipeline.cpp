@@ -0,0 +1,133 @@
+#include <iostream>
+
+#include "featurePipeline.hpp"
+#include "matching2D.hpp"
+
+using namespace std;
+
+FeaturePipeline::FeaturePipeline(const string &detectorType, const string &descriptorType, bool bFusedDetDesc)
+    : detectorType(parseDetectorType(detectorType)), descriptorType(parseDescriptorType(descriptorType)),
+      thresholdController(detectorType),
+      bFused(bFusedDetDesc && isFusedPair(detectorType, descriptorType))
+{
+    double t = (double)cv::getTickCount();
+    switch (this->detectorType)
+    {
+    case DET_SHITOMASI:
+    case DET_HARRIS:
+    {   // same parameters as detKeypointsShiTomasi / detKeypointsHarris
+        CornerParams params;
+        params.bHarris = this->detectorType == DET_HARRIS;
+        cornerDetector = CornerDetector(params);
+        detectorKind = DETECTOR_CORNERS;
+        break;
+    }
+    default:
+        detector = createFeatureDetector(detectorType);
+        detectorKind = detector ? DETECTOR_FEATURE2D : DETECTOR_NONE;
+        break;
+    }
+    if (detectorKind == DETECTOR_NONE)
+    {
+        cout << "detectorType NOT SUPPORTED" << endl;
+    }
+    if (!bFused)
+    {
+        extractor = createDescriptorExtractor(descriptorType);
+    }
+    roiPadding = detectorRoiPadding(detectorType);
+    setupTimeSec = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+double FeaturePipeline::detect(vector<cv::KeyPoint> &keypoints, const cv::Mat &img)
+{
+    double t = (double)cv::getTickCount();
+    switch (detectorKind)
+    {
+    case DETECTOR_CORNERS:
+        cornerDetector.detect(keypoints, img);
+        break;
+    case DETECTOR_FEATURE2D:
+        detector->detect(img, keypoints);
+        break;
+    default:
+        break;
+    }
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+double FeaturePipeline::detectRoi(vector<cv::KeyPoint> &keypoints, const cv::Mat &img, const vector<cv::Rect> &rois,
+                                  FrameArena *scratch)
+{
+    return detectInRois(keypoints, nullptr, img, roiPadding, rois,
+                        [&](cv::Mat &subImg, vector<cv::KeyPoint> &roiKeypoints, cv::Mat &) {
+                            return detect(roiKeypoints, subImg);
+                        }, scratch);
+}
+
+double FeaturePipeline::describe(vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+{
+    if (!extractor)
+    {
+        return 0.0;
+    }
+    double t = (double)cv::getTickCount();
+    extractor->compute(img, keypoints, descriptors);
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+double FeaturePipeline::detectAndDescribe(vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+{
+    if (!bFused)
+    {
+        double t = detect(keypoints, img);
+        return t + describe(keypoints, img, descriptors);
+    }
+    double t = (double)cv::getTickCount();
+    detector->detectAndCompute(img, cv::noArray(), keypoints, descriptors);
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+double FeaturePipeline::detectAndDescribeRoi(vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors,
+                                             const vector<cv::Rect> &rois, FrameArena *scratch)
+{
+    return detectInRois(keypoints, &descriptors, img, roiPadding, rois,
+                        [&](cv::Mat &subImg, vector<cv::KeyPoint> &roiKeypoints, cv::Mat &roiDescriptors) {
+                            return detectAndDescribe(roiKeypoints, subImg, roiDescriptors);
+                        }, scratch);
+}
+
+bool FeaturePipeline::adaptThreshold(size_t numKeypoints, const AdaptiveThresholdParams &params)
+{
+    if (detectorKind == DETECTOR_NONE || !thresholdController.update(numKeypoints, params))
+    {
+        return false;
+    }
+    applyThreshold(thresholdController.value());
+    return true;
+}
+
+void FeaturePipeline::applyThreshold(double value)
+{
+    switch (detectorType)
+    {
+    case DET_SHITOMASI:
+    case DET_HARRIS:
+        cornerDetector.setQualityLevel(value);
+        break;
+    case DET_FAST:
+        detector.dynamicCast<cv::FastFeatureDetector>()->setThreshold((int)value);
+        break;
+    case DET_ORB:
+        detector.dynamicCast<cv::ORB>()->setMaxFeatures((int)value);
+        break;
+    case DET_AKAZE:
+        detector.dynamicCast<cv::AKAZE>()->setThreshold(value);
+        break;
+    case DET_BRISK: // no threshold setter in OpenCV 4.1: rebuild (with the pattern, so it still describes for fused pairs)
+        detector = cv::BRISK::create((int)value);
+        break;
+    default:
+        break;
+    }
+}
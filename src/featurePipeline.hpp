@@ -0,0 +1,80 @@
+#ifndef featurePipeline_hpp
+#define featurePipeline_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include "cornerDetector.hpp"
+#include "frameArena.hpp"
+#include "keypointBudget.hpp"
+#include "pipelineTypes.hpp"
+#include "thresholdController.hpp"
+
+
+// Detector and descriptor of one combination, resolved once from the type strings into preconstructed
+// instances (BRISK and FREAK build their sampling patterns in the constructor, the corner detector keeps its
+// response map), so the per-frame calls neither construct objects nor dispatch on strings.
+// The detect* and describe members may be driven by two different threads (detect and describe stage of the
+// streaming pipeline), but each of them by one thread at a time; concurrent runs need their own instance.
+class FeaturePipeline
+{
+public:
+    // bFusedDetDesc: detect and describe in one pass (only for pairs accepted by isFusedPair)
+    FeaturePipeline(const std::string &detectorType, const std::string &descriptorType, bool bFusedDetDesc);
+
+    FeaturePipeline(const FeaturePipeline &) = delete;
+    FeaturePipeline &operator=(const FeaturePipeline &) = delete;
+
+    bool isValid() const { return detectorKind != DETECTOR_NONE && (bFused || extractor); }
+    bool isFused() const { return bFused; }
+    double setupTime() const { return setupTimeSec; } // time spent constructing the instances in seconds
+
+    // same semantics as detKeypoints / detKeypointsRoi / descKeypoints / detectAndDescribe(Roi); the ROI variants
+    // take their per-ROI buffers from scratch if given
+    double detect(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img);
+    double detectRoi(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, const std::vector<cv::Rect> &rois,
+                     FrameArena *scratch = nullptr);
+    double describe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors);
+    double detectAndDescribe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors);
+    double detectAndDescribeRoi(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors,
+                                const std::vector<cv::Rect> &rois, FrameArena *scratch = nullptr);
+
+    // enforceDescriptorMemory for this pipeline's descriptor type (parsed once at construction)
+    bool enforceDescriptorMemory(KeypointStore &keypoints, cv::Size imgSize, const KeypointBudget &budget,
+                                 FrameArena *scratch = nullptr) const
+    {
+        return ::enforceDescriptorMemory(keypoints, descriptorType, imgSize, budget, scratch);
+    }
+
+    // Adaptive detector threshold: feeds the keypoint count of the last frame (in the ROIs) to the
+    // ThresholdController and applies a changed parameter to the detector for the next frame. Called from the
+    // detect thread only. Returns true if the parameter changed; detectorThreshold() is its current value.
+    bool adaptThreshold(size_t numKeypoints, const AdaptiveThresholdParams &params);
+    bool hasAdaptiveThreshold() const { return thresholdController.isActive(); }
+    double detectorThreshold() const { return thresholdController.value(); }
+
+private:
+    void applyThreshold(double value);
+
+    enum DetectorKind
+    {
+        DETECTOR_NONE,
+        DETECTOR_CORNERS,  // SHITOMASI, HARRIS
+        DETECTOR_FEATURE2D // FAST, BRISK, ORB, AKAZE, SIFT
+    };
+
+    DetectorKind detectorKind = DETECTOR_NONE;
+    CornerDetector cornerDetector;
+    cv::Ptr<cv::FeatureDetector> detector; // for fused pairs it describes as well
+    cv::Ptr<cv::DescriptorExtractor> extractor;
+    DetectorType detectorType;
+    DescriptorType descriptorType;
+    ThresholdController thresholdController;
+    int roiPadding = 0;
+    bool bFused = false;
+    double setupTimeSec = 0.0;
+};
+
+#endif /* featurePipeline_hpp */
@@ -0,0 +1,242 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "featureStore.hpp"
+
+using namespace std;
+
+namespace
+{
+const char featureFileMagic[4] = {'K', 'P', 'D', 'S'};
+const uint32_t featureFileVersion = 2;
+const size_t featureFileAlign = 64;
+
+struct FeatureFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t imageHash;
+    uint64_t configHash;
+    uint32_t numKeypoints;
+    uint32_t numDetected; // DataFrame::numDetected, fed to the adaptive threshold on a hit
+    int32_t descRows;
+    int32_t descCols;
+    int32_t descType;   // OpenCV type of the descriptor matrix (CV_8U for binary, CV_32F for SIFT)
+    uint64_t descOffset; // byte offset of the first descriptor row from the start of the file
+};
+
+// cv::KeyPoint with fixed-size fields, independent of the OpenCV build
+struct StoredKeypoint
+{
+    float x, y, size, angle, response;
+    int32_t octave, classId;
+};
+
+// read-only view of a feature file, unmapped when the last cv::Mat / DataFrame referring to it lets go
+struct MappedFeatureFile
+{
+    void *data = nullptr;
+    size_t size = 0;
+
+    ~MappedFeatureFile()
+    {
+        if (data != nullptr)
+        {
+            munmap(data, size);
+        }
+    }
+};
+
+uint64_t fnv1a(const void *data, size_t numBytes, uint64_t hash = 1469598103934665603ULL)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+size_t alignUp(size_t offset)
+{
+    return (offset + featureFileAlign - 1) / featureFileAlign * featureFileAlign;
+}
+} // namespace
+
+unsigned long long hashImage(const cv::Mat &img)
+{
+    // 8 bytes per step (FNV-1a is too slow for every pixel of every frame), the tail and the shape byte-wise
+    uint64_t hash = 1469598103934665603ULL;
+    int shape[3] = {img.rows, img.cols, img.type()};
+    hash = fnv1a(shape, sizeof(shape), hash);
+    size_t rowBytes = img.cols * img.elemSize();
+    for (int r = 0; r < img.rows; ++r)
+    {
+        const uchar *row = img.ptr(r);
+        size_t i = 0;
+        for (; i + 8 <= rowBytes; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, row + i, 8);
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 29;
+        }
+        hash = fnv1a(row + i, rowBytes - i, hash);
+    }
+    return hash;
+}
+
+FeatureStore::FeatureStore(const string &directory, const string &configKey) : directory(directory)
+{
+    if (!this->directory.empty() && this->directory.back() != '/')
+    {
+        this->directory += "/";
+    }
+    configHash = fnv1a(configKey.data(), configKey.size());
+}
+
+unsigned long long FeatureStore::frameConfigHash(const string &frameKey) const
+{
+    return frameKey.empty() ? configHash : fnv1a(frameKey.data(), frameKey.size(), configHash);
+}
+
+string FeatureStore::filePath(unsigned long long imageHash, unsigned long long frameHash) const
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%016llx-%016llx.kpd", imageHash, frameHash);
+    return directory + name;
+}
+
+bool FeatureStore::load(unsigned long long imageHash, DataFrame &frame, const string &frameKey) const
+{
+    if (!isEnabled())
+    {
+        return false;
+    }
+    unsigned long long frameHash = frameConfigHash(frameKey);
+    int fd = open(filePath(imageHash, frameHash).c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FeatureFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // private writable mapping like the frame cache: nothing writes the descriptors, but a stray write must
+    // never reach the file
+    shared_ptr<MappedFeatureFile> file = make_shared<MappedFeatureFile>();
+    file->size = (size_t)st.st_size;
+    void *data = mmap(nullptr, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    file->data = data;
+
+    const FeatureFileHeader *header = static_cast<const FeatureFileHeader *>(file->data);
+    size_t keypointsEnd = sizeof(FeatureFileHeader) + (size_t)header->numKeypoints * sizeof(StoredKeypoint);
+    size_t descBytes = (size_t)max(0, header->descRows) * max(0, header->descCols) * CV_ELEM_SIZE(header->descType);
+    if (memcmp(header->magic, featureFileMagic, sizeof(header->magic)) != 0 || header->version != featureFileVersion ||
+        header->imageHash != imageHash || header->configHash != frameHash || keypointsEnd > file->size ||
+        header->descOffset < keypointsEnd || header->descOffset + descBytes > file->size ||
+        header->descRows != (int32_t)header->numKeypoints)
+    {
+        return false; // stale, foreign or inconsistent file, recomputed and overwritten by the caller
+    }
+
+    const StoredKeypoint *stored = reinterpret_cast<const StoredKeypoint *>(header + 1);
+    frame.keypoints.resize(header->numKeypoints);
+    for (uint32_t i = 0; i < header->numKeypoints; ++i)
+    {
+        const StoredKeypoint &kp = stored[i];
+        frame.keypoints[i] = cv::KeyPoint(kp.x, kp.y, kp.size, kp.angle, kp.response, kp.octave, kp.classId);
+    }
+    frame.numDetected = (int)header->numDetected;
+    frame.descriptors = cv::Mat();
+    if (descBytes > 0)
+    {   // header only: the rows stay in the mapping
+        frame.descriptors = cv::Mat(header->descRows, header->descCols, header->descType,
+                                    static_cast<uchar *>(file->data) + header->descOffset);
+    }
+    frame.featureMapping = file;
+    return true;
+}
+
+bool FeatureStore::save(unsigned long long imageHash, const DataFrame &frame, const string &frameKey) const
+{
+    if (!isEnabled())
+    {
+        return false;
+    }
+
+    FeatureFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, featureFileMagic, sizeof(header.magic));
+    header.version = featureFileVersion;
+    header.imageHash = imageHash;
+    header.configHash = frameConfigHash(frameKey);
+    header.numKeypoints = (uint32_t)frame.keypoints.size();
+    header.numDetected = (uint32_t)max(0, frame.numDetected);
+    header.descRows = frame.descriptors.rows;
+    header.descCols = frame.descriptors.cols;
+    header.descType = frame.descriptors.type();
+    header.descOffset = alignUp(sizeof(FeatureFileHeader) + frame.keypoints.size() * sizeof(StoredKeypoint));
+
+    vector<StoredKeypoint> stored(frame.keypoints.size());
+    for (size_t i = 0; i < stored.size(); ++i)
+    {
+        const cv::KeyPoint &kp = frame.keypoints[i];
+        stored[i] = {kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response, kp.octave, kp.class_id};
+    }
+
+    // unique temporary name per process and thread, renamed into place once complete
+    ostringstream tmpSuffix;
+    tmpSuffix << ".tmp." << getpid() << "." << hash<thread::id>()(this_thread::get_id());
+    string path = filePath(imageHash, header.configHash), tmpPath = path + tmpSuffix.str();
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out)
+        {
+            cout << "FeatureStore: could not create " << tmpPath << endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(stored.data()), stored.size() * sizeof(StoredKeypoint));
+        const char zeros[featureFileAlign] = {0};
+        out.write(zeros, header.descOffset - (size_t)out.tellp());
+        size_t rowBytes = frame.descriptors.cols * frame.descriptors.elemSize();
+        for (int r = 0; r < frame.descriptors.rows; ++r)
+        {   // row by row, the descriptors may be a view into larger storage
+            out.write(reinterpret_cast<const char *>(frame.descriptors.ptr(r)), rowBytes);
+        }
+        if (!out)
+        {
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef featureStore_hpp
+#define featureStore_hpp
+
+#include <string>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+
+// On-disk store of detected + described features, so parameter studies on the matching side (matcher,
+// selector, ratio, gating) do not re-run detection and description on frames they have seen before.
+// Every frame is one file in the store directory, named after the hash of the frame's pixels and the hash
+// of the configuration key (detector, descriptor and everything else that changes their output, including
+// the per-frame detector threshold):
+//   [FeatureFileHeader][StoredKeypoint x numKeypoints][descriptor rows, starting on a 64 byte boundary]
+// A loaded frame's descriptors are a cv::Mat header into the memory-mapped file (no copy); the mapping is
+// owned by DataFrame::featureMapping and goes away with the last frame referring to it. Files are written
+// to a temporary name and renamed, so concurrent runs and copies to other machines never see half a file.
+// The format is little-endian and versioned; files of another version or key are ignored (and recomputed).
+class FeatureStore
+{
+public:
+    // empty directory = disabled (load always misses, save does nothing)
+    FeatureStore(const std::string &directory, const std::string &configKey);
+
+    bool isEnabled() const { return !directory.empty(); }
+
+    // imageHash = hashImage(frame.cameraImg), frameKey = settings which change from frame to frame (the
+    // adapted detector threshold), empty if none. Returns true if the store holds the frame and then sets
+    // frame.keypoints, frame.numDetected, frame.descriptors and frame.featureMapping.
+    bool load(unsigned long long imageHash, DataFrame &frame, const std::string &frameKey = std::string()) const;
+
+    // writes frame.keypoints, frame.numDetected and frame.descriptors; returns false if the file could not be
+    // written
+    bool save(unsigned long long imageHash, const DataFrame &frame, const std::string &frameKey = std::string()) const;
+
+private:
+    unsigned long long frameConfigHash(const std::string &frameKey) const;
+    std::string filePath(unsigned long long imageHash, unsigned long long frameHash) const;
+
+    std::string directory;
+    unsigned long long configHash = 0;
+};
+
+// 64 bit hash of the pixels of an image (any type, continuous or not)
+unsigned long long hashImage(const cv::Mat &img);
+
+#endif /* featureStore_hpp */
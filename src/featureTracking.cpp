@@ -0,0 +1,607 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "dataFrameBuffer.hpp"
+#include "featureStore.hpp"
+#include "featureTracking.hpp"
+#include "matching2D.hpp"
+#include "pipelineTypes.hpp"
+#include "quantizedMatcher.hpp"
+#include "typedFeatures.hpp"
+#include "typedPipeline.hpp"
+
+using namespace std;
+
+namespace
+{
+// serializes the per-frame report when several combinations run concurrently
+mutex coutMutex;
+
+// trainFrameMatcher calls which built an index / found the frame's index in place, all threads
+atomic<size_t> numMatcherBuilds(0), numMatcherHits(0);
+
+// with bQuantizeFloat: replaces float descriptors by their RootSIFT uint8 form, in rows of the frame's arena
+// (the float rows stay in descriptorStorage, see unquantizedDescriptors). Returns the time in seconds.
+double quantizeFrameDescriptors(DataFrame &frame, const TrackingConfig &config)
+{
+    if (!config.bQuantizeFloat || frame.descriptors.empty() || frame.descriptors.type() != CV_32F)
+    {
+        return 0.0;
+    }
+    double t = (double)cv::getTickCount();
+    cv::Mat quantized = frame.scratch.rows(frame.descriptors.rows, frame.descriptors.cols, CV_8U);
+    quantizeRootSift(frame.descriptors, quantized);
+    frame.descriptors = quantized;
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+template <typename typeT>
+double calcAvg(std::vector<typeT>& vec)
+{
+    double sum = 0;
+    for (typeT elem : vec)
+    {
+        sum += elem;
+    }
+    return sum/vec.size();
+}
+} // namespace
+
+bool isSupportedCombination(const string &detectorType, const string &descriptorType)
+{
+    //Akaze as a Descriptor doesn't work with any detectors apart from itself
+    //(SIFT and ORB used to go out of memory, detectFrame now keeps them within the descriptor memory budget)
+    return isSupportedPair(parseDetectorType(detectorType), parseDescriptorType(descriptorType));
+}
+
+string descriptorCategory(const string &descriptorType)
+{
+    //if ( (descriptorType.compare("SIFT") == 0) || (descriptorType.compare("AKAZE") == 0) )
+    return isBinaryDescriptor(parseDescriptorType(descriptorType)) ? "DES_BINARY" : "DES_HOG";
+}
+
+int balanceThreads(size_t outerThreads)
+{
+    size_t numCores = max(1u, thread::hardware_concurrency());
+    int innerThreads = (int)max<size_t>(1, numCores / max<size_t>(1, outerThreads));
+    cv::setNumThreads(innerThreads);
+    return innerThreads;
+}
+
+void regionsOfInterest(const TrackingConfig &config, vector<cv::Rect> &rois)
+{
+    rois.assign(1, config.vehicleRect);
+    rois.insert(rois.end(), config.extraRois.begin(), config.extraRois.end());
+}
+
+vector<cv::Rect> regionsOfInterest(const TrackingConfig &config)
+{
+    vector<cv::Rect> rois;
+    regionsOfInterest(config, rois);
+    return rois;
+}
+
+string featureConfigKey(const TrackingConfig &config)
+{
+    // bump when detectFrame / describeFrame change their output for the same options
+    const int featureVersion = 1;
+    ostringstream key;
+    key << "v" << featureVersion << " " << config.detectorType << " " << config.descriptorType
+        << " fused=" << usesFusedDetDesc(config) << " roiDetect=" << config.bDetectInRoi
+        << " maxDescBytes=" << config.budget.maxDescriptorBytes << " quantized=" << config.bQuantizeFloat;
+    if (config.bFocusOnVehicle)
+    {
+        for (const cv::Rect &roi : regionsOfInterest(config))
+        {
+            key << " roi=" << roi.x << "," << roi.y << "," << roi.width << "," << roi.height;
+        }
+    }
+    // (the adapted detector threshold changes from frame to frame and goes into the key per frame, see
+    // detectorThresholdKey)
+    if (config.bLimitKpts)
+    {
+        const KeypointBudget &budget = config.budget;
+        key << " budget=" << budget.maxKeypoints << "," << budgetMethodName(budget.method) << "," << budget.gridCols << "x" << budget.gridRows;
+    }
+    return key.str();
+}
+
+string detectorThresholdKey(const TrackingConfig &config, double detectorThreshold)
+{
+    if (!config.bAdaptiveThreshold)
+    {
+        return string();
+    }
+    ostringstream key;
+    key << setprecision(17) << "threshold=" << detectorThreshold;
+    return key.str();
+}
+
+cv::Mat unquantizedDescriptors(const DataFrame &frame)
+{
+    const cv::Mat &storage = frame.descriptorStorage;
+    int numRows = (int)frame.keypoints.size();
+    if (frame.descriptors.depth() == CV_8U && storage.type() == CV_32F && storage.rows >= numRows &&
+        storage.cols == frame.descriptors.cols)
+    {
+        return storage.rowRange(0, numRows);
+    }
+    return frame.descriptors;
+}
+
+bool usesFusedDetDesc(const TrackingConfig &config)
+{
+    return config.bFusedDetDesc && isFusedPair(config.detectorType, config.descriptorType);
+}
+
+template <typename Features>
+double detectFrame(DataFrame &frame, const TrackingConfig &config, Features &features)
+{
+    // extract 2D keypoints from current image, straight into the frame's (reused) keypoint vector;
+    // all temporaries come from the frame's scratch arena
+    FrameArena &scratch = frame.scratch;
+    vector<cv::KeyPoint> &keypoints = frame.keypoints;
+    keypoints.clear();
+    vector<cv::Rect> &rois = scratch.rects.acquire();
+    if (config.bFocusOnVehicle)
+    {
+        regionsOfInterest(config, rois);
+    }
+    cv::Mat &descriptors = scratch.rowBuffer(); // only filled by the fused path
+    bool bFused = features.isFused();
+    double t;
+    if (config.bFocusOnVehicle && config.bDetectInRoi)
+    {   // detect on the padded ROIs only, the keypoints come back in frame coordinates
+        if (bFused)
+        {
+            t = features.detectAndDescribeRoi(keypoints, frame.cameraImg, descriptors, rois, &scratch);
+        }
+        else
+        {
+            t = features.detectRoi(keypoints, frame.cameraImg, rois, &scratch);
+        }
+    }
+    else
+    {
+        if (bFused)
+        {
+            t = features.detectAndDescribe(keypoints, frame.cameraImg, descriptors);
+        }
+        else
+        {
+            t = features.detect(keypoints, frame.cameraImg);
+        }
+    }
+
+    // From here on to the description the keypoints live in the SoA working copy, whose row array remembers the
+    // detector output index (= descriptor row of the fused path) of every keypoint
+    KeypointStore &store = scratch.keypointStore;
+    store.assign(keypoints);
+
+    if (config.bFocusOnVehicle && !config.bDetectInRoi)
+    {
+        /* Maintaining keypoints of vehicle only */
+        // only keep keypoints on the preceding vehicle: vectorized test on the SoA positions
+        vector<uchar> &inside = scratch.bytes.acquire();
+        store.markInside(rois, inside);
+        store.compact(inside);
+    }
+
+    // optional : steer the detector parameter towards the target keypoint count in the ROIs, for the next frame
+    frame.numDetected = (int)store.count();
+    if (config.bAdaptiveThreshold && features.adaptThreshold(store.count(), config.adaptiveThreshold) &&
+        config.bVerbose)
+    {
+        cout << " NOTE: detector threshold adapted to " << features.detectorThreshold() << endl;
+    }
+
+    // optional : cap the keypoints per ROI, spread uniformly over each ROI instead of the strongest cluster
+    if (config.bLimitKpts)
+    {
+        vector<cv::Rect> &regions = config.bFocusOnVehicle ? rois : scratch.rects.acquire();
+        if (!config.bFocusOnVehicle)
+        {
+            regions.assign(1, cv::Rect(0, 0, frame.cameraImg.cols, frame.cameraImg.rows));
+        }
+        applyKeypointBudget(store, regions, config.budget, &scratch);
+        if (config.bVerbose)
+        {
+            cout << " NOTE: Keypoints have been limited!" << endl;
+        }
+    }
+
+    // never let the extractor allocate more than the budget (SIFT keypoints used to make ORB ask for 70 GB)
+    if (!bFused && features.enforceDescriptorMemory(store, frame.cameraImg.size(), config.budget, &scratch) &&
+        config.bVerbose)
+    {
+        cout << " NOTE: Keypoints have been adapted to the descriptor memory budget!" << endl;
+    }
+
+    if (bFused)
+    {   // gather the descriptor rows of the surviving keypoints straight into the frame's descriptor storage
+        frame.descriptors = reuseRows(frame.descriptorStorage, (int)store.count(), descriptors.cols, descriptors.type());
+        size_t rowBytes = descriptors.cols * descriptors.elemSize();
+        for (size_t i = 0; i < store.count(); ++i)
+        {
+            memcpy(frame.descriptors.ptr((int)i), descriptors.ptr(store.row[i]), rowBytes);
+        }
+        t += quantizeFrameDescriptors(frame, config);
+    }
+
+    // API edge: the extractor and the matchers take cv::KeyPoint
+    store.toKeyPoints(keypoints);
+    return t;
+}
+
+template <typename Features>
+double describeFrame(DataFrame &frame, const TrackingConfig &config, Features &features)
+{
+    if (features.isFused())
+    {
+        return 0.0; // described by detectFrame already
+    }
+
+    // the extractor writes into the frame's storage directly, it keeps the allocation while the count is unchanged
+    double t = features.describe(frame.keypoints, frame.cameraImg, frame.descriptorStorage);
+    frame.descriptors = frame.descriptorStorage;
+    return t + quantizeFrameDescriptors(frame, config);
+}
+
+double trainFrameMatcher(DataFrame &frame, const TrackingConfig &config)
+{
+    string category = descriptorCategory(config.descriptorType);
+    if (usesHammingKernel(frame.descriptors, frame.descriptors, category, config.matcherType, config.selectorType) ||
+        usesQuantizedKernel(frame.descriptors, frame.descriptors, category, config.matcherType, config.selectorType))
+    {
+        return 0.0;
+    }
+
+    ostringstream key;
+    key << config.matcherType << "/" << category;
+    if (parseMatcherType(config.matcherType) == MATCHER_FLANN)
+    {
+        key << "/" << config.lshParams.tableNumber << "," << config.lshParams.keySize << "," << config.lshParams.multiProbeLevel;
+    }
+    if (frame.matcher && frame.matcherKey == key.str())
+    {
+        ++numMatcherHits;
+        return 0.0; // already indexed
+    }
+
+    double t = (double)cv::getTickCount();
+    frame.matcher = trainMatcher(frame.descriptors, category, config.matcherType, config.lshParams);
+    frame.matcherKey = key.str();
+    ++numMatcherBuilds;
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+size_t matcherIndexBuilds()
+{
+    return numMatcherBuilds;
+}
+
+size_t matcherIndexHits()
+{
+    return numMatcherHits;
+}
+
+bool matchesFromCurrentFrame(const DataFrame &prevFrame, const DataFrame &currFrame, const TrackingConfig &config)
+{
+    string category = descriptorCategory(config.descriptorType);
+    return !(config.bGatedMatching && hasMotionSupport(prevFrame, config.gridParams)) &&
+           !usesHammingKernel(prevFrame.descriptors, currFrame.descriptors, category, config.matcherType, config.selectorType) &&
+           !usesQuantizedKernel(prevFrame.descriptors, currFrame.descriptors, category, config.matcherType, config.selectorType);
+}
+
+void matchFramesReference(DataFrame &prevFrame, DataFrame &currFrame, const cv::Mat &descPrev, const cv::Mat &descCurr,
+                          const string &matcherType, const TrackingConfig &config, vector<cv::DMatch> &matches)
+{
+    string category = descriptorCategory(config.descriptorType);
+    if (!matchesFromCurrentFrame(prevFrame, currFrame, config))
+    {
+        matchDescriptors(prevFrame.keypoints, currFrame.keypoints, descPrev, descCurr, matches, category, matcherType,
+                         config.selectorType, config.lshParams, nullptr, false);
+        return;
+    }
+    matchDescriptors(currFrame.keypoints, prevFrame.keypoints, descCurr, descPrev, matches, category, matcherType,
+                     config.selectorType, config.lshParams, nullptr, false);
+    for (cv::DMatch &match : matches)
+    {
+        swap(match.queryIdx, match.trainIdx);
+    }
+}
+
+double matchFrames(DataFrame &prevFrame, DataFrame &currFrame, const TrackingConfig &config)
+{
+    // matches go straight into the current data frame, their displacements drive the prediction for the next frame
+    vector<cv::DMatch> &matches = currFrame.kptMatches;
+    matches.clear();
+    double t = (double)cv::getTickCount();
+    string category = descriptorCategory(config.descriptorType);
+    if (config.bGatedMatching && hasMotionSupport(prevFrame, config.gridParams))
+    {   // only compare against reference keypoints near the position predicted from the last displacements
+        int normType = descriptorNormType(parseDescriptorType(config.descriptorType));
+        matchDescriptorsGated(prevFrame, currFrame, matches, normType, config.selectorType, config.gridParams, nullptr,
+                              &currFrame.scratch);
+    }
+    else if (!matchesFromCurrentFrame(prevFrame, currFrame, config))
+    {   // brute force SIMD matching (Hamming or integer L2), there is no index to keep
+        matchDescriptors(prevFrame.keypoints, currFrame.keypoints,
+                         prevFrame.descriptors, currFrame.descriptors,
+                         matches, category, config.matcherType, config.selectorType,
+                         config.lshParams, &currFrame.scratch);
+    }
+    else
+    {   // query the previous frame's index, built when that frame was described (or here, once), with the current
+        // descriptors; the index side is the query of kptMatches, so the roles are swapped back. The ratio test
+        // then runs per current keypoint, i.e. every current keypoint has at most one match.
+        trainFrameMatcher(prevFrame, config);
+        matchDescriptors(prevFrame.matcher, currFrame.descriptors, matches, config.selectorType, &currFrame.scratch,
+                         config.bVerbose);
+        for (cv::DMatch &match : matches)
+        {
+            swap(match.queryIdx, match.trainIdx);
+        }
+    }
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+
+    updateKeypointFlow(prevFrame.keypoints, currFrame);
+    return t;
+}
+
+double verifyFrameMatches(const DataFrame &prevFrame, DataFrame &currFrame, const TrackingConfig &config,
+                          VerifyStats *stats)
+{
+    if (!config.bVerifyMatches)
+    {
+        return 0.0;
+    }
+    double t = (double)cv::getTickCount();
+    verifyMatches(prevFrame.keypoints, currFrame.keypoints, currFrame.kptMatches, currFrame.kptMatchInliers,
+                  config.verifyParams, nullptr, stats, &currFrame.scratch);
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+double matchReferenceFrames(DataFrameBuffer &buffer, const TrackingConfig &config, ReferenceIndex &index,
+                            MultiRefMatches &multiMatches)
+{
+    // the matches with the previous frame keep matchFrames' orientation (previous frame = query), so flow,
+    // counts and recall are those of single-reference matching; the index pass queries with the current frame
+    DataFrame &currFrame = buffer.current();
+    double tPrev = matchFrames(buffer.previous(), currFrame, config);
+    double t = (double)cv::getTickCount();
+    index.build(buffer, (size_t)max(1, config.numReferenceFrames));
+    int normType = descriptorNormType(parseDescriptorType(config.descriptorType));
+    matchMultiReference(index, currFrame.descriptors, normType, config.selectorType, multiMatches, &currFrame.scratch);
+    currFrame.kptMatchesMultiRef.assign(multiMatches.best.begin(), multiMatches.best.end());
+    return tPrev + ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+CombinationResult runCombination(const TrackingConfig &config, const FrameCache &frameCache)
+{
+    CombinationResult result;
+    if (!isSupportedCombination(config.detectorType, config.descriptorType))
+    {
+        if (config.bVerbose)
+        {
+            lock_guard<mutex> lock(coutMutex);
+            std::cout << "Skipping...";
+            std::cout << "Using: " << config.detectorType << ", " << config.descriptorType << std::endl;
+        }
+        result.bSkipped = true;
+        return result;
+    }
+
+    // the instantiated pairs run with their detector / descriptor / fused decision fixed at compile time
+    if (runTypedPipeline(config, frameCache, result))
+    {
+        return result;
+    }
+
+    // detector / descriptor instances are built once per combination, not per frame
+    FeaturePipeline features(config.detectorType, config.descriptorType, usesFusedDetDesc(config));
+    return runCombination(config, frameCache, features);
+}
+
+template <typename Features>
+CombinationResult runCombination(const TrackingConfig &config, const FrameCache &frameCache, Features &features)
+{
+    CombinationResult result;
+    const string &detectorType = config.detectorType;
+    const string &descriptorType = config.descriptorType;
+
+    // frames seen before with the same detection settings are loaded instead of detected + described
+    FeatureStore featureStore(config.featureStoreDir, featureConfigKey(config));
+
+    // each combination owns its buffer, so mixed up comparisons (previous SHITOM,BRISK compared
+    // with latest SHITOM,BRIEF) cannot happen and combinations can run independently.
+    // Needs to hold at least two images since a constant velocity model is being used.
+    // Else might need upto 3 or more (if acceleration etc model are used).
+    // (with multi-reference matching: the current frame plus numReferenceFrames references)
+    DataFrameBuffer dataBuffer(max(max(2, config.dataBufferSize), config.numReferenceFrames + 1)); // data frames which are held in memory at the same time
+    ReferenceIndex referenceIndex;
+    MultiRefMatches multiMatches;
+    bool bMultiRef = config.numReferenceFrames > 1;
+    vector<int> tenImgKptsNum;
+    vector<int> tenImgMatchedKptsNum;
+    vector<double> tenImgDetDescTime;
+    vector<double> tenImgMatchTime;
+    vector<double> tenImgRecall;
+    // (not with multi-reference matching: its timing and kptMatchesMultiRef are not what MAT_BF is compared to)
+    bool bEvalRecall = config.bEvalRecall && parseMatcherType(config.matcherType) != MATCHER_BF && config.numReferenceFrames <= 1;
+
+    // optional : keypoints of the frames between keyframes are tracked by optical flow, inside the same regions
+    KltTracker tracker(config.klt);
+    vector<cv::Rect> trackRois;
+    if (config.bFocusOnVehicle)
+    {
+        regionsOfInterest(config, trackRois);
+    }
+
+    for (size_t imgIndex = 0; imgIndex < frameCache.size(); imgIndex++)
+    {
+        /* LOAD IMAGE INTO BUFFER */
+        // grayscale frame from the cache (shares the decoded pixels, no copy)
+        cv::Mat imgGray = frameCache.frame(imgIndex);
+
+        /* Ring Buffer Implementation */
+        // the oldest slot is overwritten in place once the buffer is full
+        DataFrame &currFrame = dataBuffer.push(imgGray);
+        if (!config.bFocusOnVehicle && trackRois.empty())
+        {
+            trackRois.assign(1, cv::Rect(0, 0, imgGray.cols, imgGray.rows));
+        }
+
+        double keyTime = 0.0, trackTime = 0.0;
+        bool bTracked = config.bKltTracking && dataBuffer.size() > 1 && !tracker.needsKeyframe();
+        unsigned long long imageHash = featureStore.isEnabled() ? hashImage(imgGray) : 0;
+        string thresholdKey = featureStore.isEnabled() ? detectorThresholdKey(config, features.detectorThreshold()) : string();
+        double t = (double)cv::getTickCount();
+        if (bTracked)
+        {   /* TRACK KEYPOINTS OF THE PREVIOUS FRAME (fills the matches too) */
+            trackTime = tracker.track(dataBuffer.previous(), currFrame, trackRois);
+        }
+        else if (featureStore.load(imageHash, currFrame, thresholdKey))
+        {
+            // the detector parameter follows the stored frame as if it had been detected
+            if (config.bAdaptiveThreshold)
+            {
+                features.adaptThreshold(currFrame.numDetected, config.adaptiveThreshold);
+            }
+            keyTime = ((double)cv::getTickCount() - t) / cv::getTickFrequency(); // time of the lookup
+        }
+        else
+        {
+            /* DETECT IMAGE KEYPOINTS */
+            keyTime = detectFrame(currFrame, config, features);
+
+            /* EXTRACT KEYPOINT DESCRIPTORS */
+            keyTime += describeFrame(currFrame, config, features);
+
+            featureStore.save(imageHash, currFrame, thresholdKey);
+        }
+        if (config.bKltTracking && !bTracked)
+        {
+            tracker.setKeyframe(currFrame, trackRois);
+        }
+
+        if (dataBuffer.size() > 1) // wait until at least two images have been processed
+        {
+
+            /* MATCH KEYPOINT DESCRIPTORS */
+            // (tracked frames got their matches from the optical flow, the tracking time counts as matching time)
+            DataFrame &prevFrame = dataBuffer.previous();
+            double matchTime = bTracked ? trackTime
+                             : bMultiRef ? matchReferenceFrames(dataBuffer, config, referenceIndex, multiMatches)
+                                         : matchFrames(prevFrame, currFrame, config);
+            VerifyStats verifyStats;
+            double verifyTime = verifyFrameMatches(prevFrame, currFrame, config, &verifyStats);
+            const vector<cv::KeyPoint> &keypoints = currFrame.keypoints;
+            const vector<cv::DMatch> &matches = currFrame.kptMatches;
+
+            if (bEvalRecall && !bTracked)
+            {   // exact brute force matches as ground truth for the approximate matcher
+                vector<cv::DMatch> exactMatches;
+                matchFramesReference(prevFrame, currFrame, prevFrame.descriptors, currFrame.descriptors, "MAT_BF", config,
+                                     exactMatches);
+                tenImgRecall.push_back(matchRecall(matches, exactMatches));
+            }
+
+            if (config.bVis)
+            {
+                cv::Mat matchImg = (currFrame.cameraImg).clone();
+
+                cv::drawMatches(prevFrame.cameraImg, prevFrame.keypoints,
+                                currFrame.cameraImg, currFrame.keypoints,
+                                matches, matchImg,
+                                cv::Scalar::all(-1), cv::Scalar::all(-1),
+                                vector<char>(), cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+                string windowName = "Matching keypoints between two camera images";
+                cv::namedWindow(windowName, 7);
+                cv::imshow(windowName, matchImg);
+                cout << "Press key to continue to next image" << endl;
+                cv::waitKey(0); // wait for key to be pressed
+            }
+            if (config.bVerbose)
+            {
+                lock_guard<mutex> lock(coutMutex);
+                std::cout << "----------" << std::endl;
+                std::cout << "Detector: " << detectorType << std::endl;
+                std::cout << "Descriptor: " << descriptorType << std::endl;
+                if (config.bKltTracking)
+                {
+                    std::cout << (bTracked ? "Tracked (KLT)" : "Keyframe") << std::endl;
+                }
+                std::cout << "Total Keypoints: " << keypoints.size() << std::endl;
+                std::cout << "Matched Keypoints: " << matches.size() << std::endl;
+                if (bMultiRef && !bTracked)
+                {
+                    std::cout << "Matched Keypoints (last " << config.numReferenceFrames << " frames): "
+                              << currFrame.kptMatchesMultiRef.size() << std::endl;
+                }
+                std::cout << "Detection + Description Time (ms): " << keyTime*1000 << std::endl;
+                std::cout << "Matching Time (ms): " << matchTime*1000 << std::endl;
+                if (config.bVerifyMatches)
+                {
+                    std::cout << "Inlier Matches (" << config.verifyParams.model << "): " << verifyStats.numInliers
+                              << " after " << verifyStats.numIterations << " iterations" << std::endl;
+                    std::cout << "Verification Time (ms): " << verifyTime*1000 << std::endl;
+                }
+                if (bEvalRecall && !bTracked)
+                {
+                    std::cout << "Matching Recall vs. MAT_BF: " << tenImgRecall.back() << std::endl;
+                }
+                std::cout << "==========" << std::endl;
+            }
+
+            tenImgKptsNum.push_back(keypoints.size());
+            tenImgMatchedKptsNum.push_back(matches.size());
+            tenImgDetDescTime.push_back(keyTime*1000);
+            tenImgMatchTime.push_back(matchTime*1000);
+        } // eof ensure dataBuffer size greater than 1
+    } // eof loop over all images
+
+    if (!tenImgKptsNum.empty())
+    {
+        result.avgKptsNum = calcAvg(tenImgKptsNum);
+        result.avgMatchedKptsNum = calcAvg(tenImgMatchedKptsNum);
+        result.avgDetDescTime = calcAvg(tenImgDetDescTime);
+        result.avgMatchTime = calcAvg(tenImgMatchTime);
+        if (!tenImgRecall.empty())
+        {
+            result.avgRecall = calcAvg(tenImgRecall);
+        }
+    }
+    else
+    {
+        result.bSkipped = true;
+    }
+    return result;
+}
+
+// the stages and the sweep for the runtime configured pipeline and every TypedFeatures of typedFeatures.hpp
+#define INSTANTIATE_FRAME_STAGES(...)                                                                               \
+    template double detectFrame<__VA_ARGS__>(DataFrame &, const TrackingConfig &, __VA_ARGS__ &);                  \
+    template double describeFrame<__VA_ARGS__>(DataFrame &, const TrackingConfig &, __VA_ARGS__ &);                \
+    template CombinationResult runCombination<__VA_ARGS__>(const TrackingConfig &, const FrameCache &, __VA_ARGS__ &);
+
+INSTANTIATE_FRAME_STAGES(FeaturePipeline)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_SHITOMASI, DESC_BRISK>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_FAST, DESC_BRIEF>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_FAST, DESC_ORB>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_ORB, DESC_ORB, true>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_ORB, DESC_ORB, false>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_BRISK, DESC_BRISK, true>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_BRISK, DESC_BRISK, false>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_AKAZE, DESC_AKAZE, true>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_AKAZE, DESC_AKAZE, false>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_SIFT, DESC_SIFT, true>)
+INSTANTIATE_FRAME_STAGES(TypedFeatures<DET_SIFT, DESC_SIFT, false>)
+
+#undef INSTANTIATE_FRAME_STAGES
@@ -0,0 +1,153 @@
+#ifndef featureTracking_hpp
+#define featureTracking_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+#include "featurePipeline.hpp"
+#include "frameCache.hpp"
+#include "geometricVerifier.hpp"
+#include "gridMatcher.hpp"
+#include "keypointBudget.hpp"
+#include "kltTracker.hpp"
+#include "matching2D.hpp"
+#include "referenceIndex.hpp"
+
+
+// everything that selects how one detector/descriptor combination is run over a sequence
+struct TrackingConfig
+{
+    std::string detectorType = "SHITOMASI";  // SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE, SIFT
+    std::string descriptorType = "BRISK";    // BRISK, BRIEF, ORB, FREAK, AKAZE, SIFT
+    std::string matcherType = "MAT_BF";      // MAT_BF, MAT_FLANN
+    std::string selectorType = "SEL_KNN";    // SEL_NN, SEL_KNN
+    LshParams lshParams;                     // LSH index of MAT_FLANN for binary descriptors
+    bool bEvalRecall = false;                // for approximate matchers: also match exactly (MAT_BF) and report the recall
+    bool bQuantizeFloat = false;             // store float descriptors (SIFT) as RootSIFT uint8, matched by integer L2
+    int numReferenceFrames = 1;              // >1: also match against the last K frames in one pass (kptMatchesMultiRef)
+    bool bGatedMatching = false;             // motion-predicted, grid-gated matching (falls back to matcherType without support)
+    GridMatchParams gridParams;
+    bool bVerifyMatches = false;             // fit a homography / fundamental matrix to kptMatches (kptMatchInliers)
+    VerifyParams verifyParams;
+
+    bool bFocusOnVehicle = true;             // only keep keypoints on the preceding vehicle
+    cv::Rect vehicleRect = cv::Rect(535, 180, 180, 150);
+    std::vector<cv::Rect> extraRois;         // further regions of interest (e.g. more vehicles) next to vehicleRect
+    bool bDetectInRoi = false;               // run the detector on the (padded) ROIs only instead of the full frame
+    bool bFusedDetDesc = true;               // same-family pairs (ORB, BRISK, AKAZE, SIFT) detect and describe in one pass
+
+    bool bAdaptiveThreshold = false;         // adapt the detector threshold frame to frame to a keypoint target band
+    AdaptiveThresholdParams adaptiveThreshold;
+
+    bool bLimitKpts = false;                 // limit number of keypoints per ROI to budget.maxKeypoints
+    KeypointBudget budget;                   // keypoint cap / selection and descriptor memory limit
+
+    bool bKltTracking = false;               // detect + describe keyframes only, track with optical flow in between
+    KltParams klt;
+
+    std::string featureStoreDir;             // on-disk FeatureStore of keypoints + descriptors, empty = always detect
+
+    int dataBufferSize = 2;                  // no. of images which are held in memory (ring buffer) at the same time
+    bool bVis = false;                       // visualize results
+    bool bVerbose = true;                    // print per-frame results to stdout
+};
+
+// per-combination averages over all matched frames, i.e. one cell of the detector x descriptor tables
+struct CombinationResult
+{
+    bool bSkipped = false;
+    double avgKptsNum = 0.0;
+    double avgMatchedKptsNum = 0.0;
+    double avgDetDescTime = 0.0; // ms
+    double avgMatchTime = 0.0;   // ms
+    double avgRecall = -1.0;     // recall of the matcher vs. exact matching, -1 if not evaluated
+};
+
+// false for the combinations which are known not to work (see NOTE 1 and NOTE 2 in the main file)
+bool isSupportedCombination(const std::string &detectorType, const std::string &descriptorType);
+
+// DES_HOG for gradient based (float) descriptors, DES_BINARY otherwise
+std::string descriptorCategory(const std::string &descriptorType);
+
+// Splits the cores between combinations running concurrently (outer parallelism) and OpenCV's own
+// parallel_for_ inside the detectors/descriptors (inner parallelism), so that outer x inner threads
+// do not oversubscribe the machine. Returns the number of threads OpenCV was set to.
+int balanceThreads(size_t outerThreads);
+
+// vehicleRect followed by extraRois (the second overload fills a reused vector)
+std::vector<cv::Rect> regionsOfInterest(const TrackingConfig &config);
+void regionsOfInterest(const TrackingConfig &config, std::vector<cv::Rect> &rois);
+
+// everything which changes the keypoints / descriptors of a frame (detector, descriptor, ROIs, budget), as the
+// configuration key of the FeatureStore. The matching options are left out, they share the stored features.
+std::string featureConfigKey(const TrackingConfig &config);
+
+// the per-frame part of the FeatureStore key: the detector parameter the next frame is detected with
+// (detectorThreshold() of the pipeline) when it is adapted (bAdaptiveThreshold), empty otherwise
+std::string detectorThresholdKey(const TrackingConfig &config, double detectorThreshold);
+
+// the float rows of a frame whose descriptors were quantized (bQuantizeFloat), e.g. to compare against float
+// matching; frame.descriptors for any other frame
+cv::Mat unquantizedDescriptors(const DataFrame &frame);
+
+// true if detectFrame describes the keypoints too (bFusedDetDesc and a same-family pair), sharing one scale space
+bool usesFusedDetDesc(const TrackingConfig &config);
+
+// per-frame stages, shared by the sweep and the streaming pipeline. Each returns its time in seconds.
+// detectFrame also restricts the keypoints to the regions of interest, applies the optional keypoint budget and
+// drops keypoints if describing them would exceed budget.maxDescriptorBytes, all on the SoA KeypointStore of the
+// frame's arena; frame.keypoints is only written at the end. For fused pairs detectFrame returns detection +
+// description time and describeFrame does nothing.
+// The instances come from a FeaturePipeline built once per run from the same configuration, or from the
+// TypedFeatures of the pair (typedFeatures.hpp); both are instantiated in featureTracking.cpp.
+template <typename Features>
+double detectFrame(DataFrame &frame, const TrackingConfig &config, Features &features);
+template <typename Features>
+double describeFrame(DataFrame &frame, const TrackingConfig &config, Features &features);
+double matchFrames(DataFrame &prevFrame, DataFrame &currFrame, const TrackingConfig &config);
+
+// true if matchFrames searches from the current frame (querying the previous frame's index, so every current
+// keypoint has at most one match), false if it searches from the previous frame (gated and SIMD matchers).
+// kptMatches are oriented queryIdx = previous keypoint, trainIdx = current keypoint either way.
+bool matchesFromCurrentFrame(const DataFrame &prevFrame, const DataFrame &currFrame, const TrackingConfig &config);
+
+// Matches descPrev with descCurr (e.g. exact or unquantized rows of the two frames) by matcherType, searching in
+// the same direction as matchFrames, so the result can be compared with kptMatches by matchRecall.
+void matchFramesReference(DataFrame &prevFrame, DataFrame &currFrame, const cv::Mat &descPrev, const cv::Mat &descCurr,
+                          const std::string &matcherType, const TrackingConfig &config, std::vector<cv::DMatch> &matches);
+
+// Geometric verification of currFrame.kptMatches against prevFrame (PROSAC over the matches ranked by distance,
+// see verifyMatches); writes currFrame.kptMatchInliers and returns the time in seconds. Does nothing without
+// config.bVerifyMatches.
+double verifyFrameMatches(const DataFrame &prevFrame, DataFrame &currFrame, const TrackingConfig &config,
+                          VerifyStats *stats = nullptr);
+
+// Matches the current frame of the buffer against its last config.numReferenceFrames frames in one pass over
+// a shared index (rebuilt in place), with the current frame's descriptors as the queries: kptMatchesMultiRef
+// gets the best match of every current keypoint over all references (queryIdx = current keypoint). kptMatches
+// is set by matchFrames with the previous frame, unchanged. Returns the time of both in seconds.
+double matchReferenceFrames(DataFrameBuffer &buffer, const TrackingConfig &config, ReferenceIndex &index,
+                            MultiRefMatches &multiMatches);
+
+// Builds the matcher/index over the frame's descriptors unless the frame already holds one for the same
+// configuration, so every frame is indexed exactly once while it is in the buffer. Does nothing when the
+// configuration uses the index-free SIMD Hamming matcher. Returns the build time in seconds.
+// matchFrames queries the previous frame's index with the current descriptors, so a frame indexed right after
+// its description (as the streaming pipeline and the benchmark do) is matched without building anything.
+double trainFrameMatcher(DataFrame &frame, const TrackingConfig &config);
+
+// no. of trainFrameMatcher calls since program start which built an index / reused the frame's index (all threads)
+size_t matcherIndexBuilds();
+size_t matcherIndexHits();
+
+// runs detection, description and matching over all frames of the cache (with bKltTracking: over the keyframes,
+// the frames in between are tracked). Pairs with a TypedFeatures instantiation run on it (runTypedPipeline),
+// the others on a FeaturePipeline.
+CombinationResult runCombination(const TrackingConfig &config, const FrameCache &frameCache);
+// the same with the given detector / descriptor instances, which must match config (see runTypedPipeline)
+template <typename Features>
+CombinationResult runCombination(const TrackingConfig &config, const FrameCache &frameCache, Features &features);
+
+#endif /* featureTracking_hpp */
@@ -0,0 +1,63 @@
+#include <algorithm>
+
+#include "frameArena.hpp"
+
+using namespace std;
+
+cv::Mat &FrameArena::nextMat()
+{
+    if (numMats == mats.size())
+    {
+        mats.emplace_back();
+    }
+    return mats[numMats++];
+}
+
+cv::Mat &FrameArena::rowBuffer()
+{
+    cv::Mat &buffer = nextMat();
+    if (buffer.data)
+    {
+        buffer.resize(0); // keeps the allocation, push_back grows into it again
+    }
+    return buffer;
+}
+
+cv::Mat FrameArena::rows(int rows, int cols, int type)
+{
+    return reuseRows(nextMat(), rows, cols, type);
+}
+
+void FrameArena::reset()
+{
+    keypoints.reset();
+    knnMatches.reset();
+    rects.reset();
+    floats.reset();
+    ints.reset();
+    bytes.reset();
+    numMats = 0;
+}
+
+cv::Mat reuseRows(cv::Mat &storage, int rows, int cols, int type)
+{
+    if (rows <= 0 || cols <= 0)
+    {
+        return cv::Mat();
+    }
+    // compare against the full allocation, storage may have been shrunk by FrameArena::rowBuffer
+    size_t capacityRows = storage.data && storage.step[0] > 0 ? (storage.datalimit - storage.datastart) / storage.step[0] : 0;
+    if (storage.cols != cols || storage.type() != type)
+    {
+        storage.create(rows, cols, type);
+    }
+    else if (capacityRows < (size_t)rows)
+    {
+        storage.create(max(rows, (int)(capacityRows + capacityRows / 2)), cols, type);
+    }
+    else if (storage.rows < rows)
+    {
+        storage.resize(rows); // within the allocation, no copy
+    }
+    return storage.rowRange(0, rows);
+}
@@ -0,0 +1,73 @@
+#ifndef frameArena_hpp
+#define frameArena_hpp
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "keypointStore.hpp"
+
+
+
+// Pool of vectors handed out one after another during a frame and all taken back at once by reset().
+// A buffer comes out cleared but with the capacity it reached in earlier frames.
+template <typename T>
+class ScratchPool
+{
+public:
+    std::vector<T> &acquire()
+    {
+        if (numUsed == buffers.size())
+        {
+            buffers.emplace_back();
+        }
+        std::vector<T> &buffer = buffers[numUsed++];
+        buffer.clear();
+        return buffer;
+    }
+
+    void reset() { numUsed = 0; }
+
+private:
+    std::deque<std::vector<T>> buffers; // a deque, so handed out references stay valid while the pool grows
+    size_t numUsed = 0;
+};
+
+// Scratch storage for the intermediates of one frame (keypoint copies, regions of interest, ROI detections,
+// kNN candidates, grid buckets, ...). The stages of a frame draw from it instead of allocating their own
+// temporaries and the owner resets it when the frame is done (DataFrameBuffer::push does so for the slot it
+// reuses), so once the arena has seen the largest frame of a sequence it no longer allocates.
+// Acquired buffers are valid until the next reset(). Not thread-safe: the stages of one frame run one after
+// another, also in the streaming pipeline.
+class FrameArena
+{
+public:
+    ScratchPool<cv::KeyPoint> keypoints;
+    ScratchPool<std::vector<cv::DMatch>> knnMatches;
+    ScratchPool<cv::Rect> rects;
+    ScratchPool<float> floats;
+    ScratchPool<int> ints;
+    ScratchPool<uchar> bytes;
+    KeypointStore keypointStore; // SoA working copy of the detections (overwritten by each assign)
+
+    // empty matrix which keeps the row storage of earlier frames, to be filled with push_back
+    cv::Mat &rowBuffer();
+
+    // rows x cols matrix (uninitialized) viewing pooled storage which only grows
+    cv::Mat rows(int rows, int cols, int type);
+
+    void reset();
+
+private:
+    cv::Mat &nextMat();
+
+    std::deque<cv::Mat> mats;
+    size_t numMats = 0;
+};
+
+// First rows of storage as a rows x cols matrix. storage is reallocated only if it is too small (then by half
+// again its rows) or of a different width / type; its previous content is not preserved.
+cv::Mat reuseRows(cv::Mat &storage, int rows, int cols, int type);
+
+#endif /* frameArena_hpp */
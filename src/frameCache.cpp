@@ -0,0 +1,247 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "frameCache.hpp"
+#include "frameSource.hpp"
+
+using namespace std;
+
+namespace
+{
+// on-disk layout of the raw frame cache:
+// [RawCacheHeader][RawFrameEntry x numFrames][pixel data, each frame starting on a 64 byte boundary]
+const char rawCacheMagic[4] = {'F', 'R', 'C', '1'};
+const size_t rawCacheAlign = 64;
+
+struct RawCacheHeader
+{
+    char magic[4];
+    uint32_t numFrames;
+    uint64_t listHash; // hash over the image files (names, sizes, modification times) the cache was built from
+};
+
+struct RawFrameEntry
+{
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t offset; // byte offset of the first pixel from the start of the file
+};
+
+void hashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+// FNV-1a over the filenames and each file's size and modification time, so a cache file built for a
+// different sequence, or before an image was edited in place, is never picked up
+unsigned long long hashImageFiles(const vector<string> &imgFilenames)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (const string &name : imgFilenames)
+    {
+        hashBytes(hash, name.data(), name.size());
+        struct stat st;
+        int64_t fileStamp[3] = {-1, -1, -1}; // missing file: decoding fails anyway
+        if (stat(name.c_str(), &st) == 0)
+        {
+            fileStamp[0] = (int64_t)st.st_size;
+            fileStamp[1] = (int64_t)st.st_mtim.tv_sec;
+            fileStamp[2] = (int64_t)st.st_mtim.tv_nsec;
+        }
+        hashBytes(hash, fileStamp, sizeof(fileStamp));
+        hash = (hash ^ 0xff) * 1099511628211ULL; // separator
+    }
+    return hash;
+}
+
+size_t alignUp(size_t offset)
+{
+    return (offset + rawCacheAlign - 1) / rawCacheAlign * rawCacheAlign;
+}
+} // namespace
+
+FrameCache::~FrameCache()
+{
+    unmap();
+}
+
+bool FrameCache::load(const vector<string> &imgFilenames, const string &rawCachePath)
+{
+    double t = (double)cv::getTickCount();
+    unmap();
+    frames.clear();
+
+    bool ok;
+    if (rawCachePath.empty())
+    {
+        ok = decodeAll(imgFilenames);
+    }
+    else
+    {
+        unsigned long long listHash = hashImageFiles(imgFilenames);
+        ok = mapRawFile(rawCachePath, listHash);
+        if (!ok)
+        {   // no usable cache file yet: decode once, write the raw pixels and map the result
+            ok = decodeAll(imgFilenames) && writeRawFile(rawCachePath, listHash);
+            frames.clear();
+            ok = ok && mapRawFile(rawCachePath, listHash);
+        }
+    }
+    loadTimeSec = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    return ok;
+}
+
+bool FrameCache::load(FrameSource &source)
+{
+    double t = (double)cv::getTickCount();
+    unmap();
+    frames.clear();
+
+    FramePrefetcher prefetcher(source);
+    cv::Mat imgGray;
+    while (prefetcher.read(imgGray))
+    {
+        frames.push_back(imgGray);
+    }
+    loadTimeSec = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    if (frames.empty())
+    {
+        cout << "FrameCache: the source has no frames" << endl;
+    }
+    return !frames.empty();
+}
+
+bool FrameCache::decodeAll(const vector<string> &imgFilenames)
+{
+    frames.reserve(imgFilenames.size());
+    for (const string &imgFullFilename : imgFilenames)
+    {
+        // load image from file and convert to grayscale
+        cv::Mat img = cv::imread(imgFullFilename);
+        if (img.empty())
+        {
+            cout << "FrameCache: could not read " << imgFullFilename << endl;
+            return false;
+        }
+        cv::Mat imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        frames.push_back(imgGray);
+    }
+    return true;
+}
+
+bool FrameCache::writeRawFile(const string &rawCachePath, unsigned long long listHash) const
+{
+    ofstream out(rawCachePath, ios::binary | ios::trunc);
+    if (!out)
+    {
+        cout << "FrameCache: could not create " << rawCachePath << endl;
+        return false;
+    }
+
+    RawCacheHeader header;
+    memcpy(header.magic, rawCacheMagic, sizeof(header.magic));
+    header.numFrames = (uint32_t)frames.size();
+    header.listHash = listHash;
+
+    vector<RawFrameEntry> entries(frames.size());
+    size_t offset = alignUp(sizeof(RawCacheHeader) + entries.size() * sizeof(RawFrameEntry));
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        entries[i].rows = (uint32_t)frames[i].rows;
+        entries[i].cols = (uint32_t)frames[i].cols;
+        entries[i].offset = offset;
+        offset = alignUp(offset + frames[i].total());
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(RawFrameEntry));
+
+    const char zeros[rawCacheAlign] = {0};
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        out.write(zeros, entries[i].offset - (size_t)out.tellp());
+        for (int r = 0; r < frames[i].rows; ++r)
+        {   // row by row, so non-continuous frames are written correctly as well
+            out.write(reinterpret_cast<const char *>(frames[i].ptr(r)), frames[i].cols);
+        }
+    }
+    return (bool)out;
+}
+
+bool FrameCache::mapRawFile(const string &rawCachePath, unsigned long long listHash)
+{
+    int fd = open(rawCachePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RawCacheHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // private writable mapping: OpenCV only reads the frames, but a stray write must never reach the file
+    size_t fileSize = (size_t)st.st_size;
+    void *data = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    mappedData = data;
+    mappedSize = fileSize;
+
+    const RawCacheHeader *header = static_cast<const RawCacheHeader *>(mappedData);
+    size_t tableEnd = sizeof(RawCacheHeader) + (size_t)header->numFrames * sizeof(RawFrameEntry);
+    if (memcmp(header->magic, rawCacheMagic, sizeof(header->magic)) != 0 || header->listHash != listHash ||
+        tableEnd > fileSize)
+    {
+        unmap();
+        return false;
+    }
+
+    const RawFrameEntry *entries = reinterpret_cast<const RawFrameEntry *>(header + 1);
+    uchar *base = static_cast<uchar *>(mappedData);
+    frames.reserve(header->numFrames);
+    for (uint32_t i = 0; i < header->numFrames; ++i)
+    {
+        if (entries[i].offset + (uint64_t)entries[i].rows * entries[i].cols > fileSize)
+        {
+            cout << "FrameCache: truncated cache file " << rawCachePath << endl;
+            frames.clear();
+            unmap();
+            return false;
+        }
+        // header only: the cv::Mat points straight into the mapping
+        frames.push_back(cv::Mat(entries[i].rows, entries[i].cols, CV_8UC1, base + entries[i].offset));
+    }
+    return true;
+}
+
+void FrameCache::unmap()
+{
+    if (mappedData != nullptr)
+    {
+        frames.clear(); // the headers must not outlive the mapping
+        munmap(mappedData, mappedSize);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef frameCache_hpp
+#define frameCache_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+class FrameSource;
+
+// Holds the grayscale version of every frame of an image sequence so that each PNG is decoded and
+// converted exactly once, no matter how many detector/descriptor combinations read it afterwards.
+// frame() hands out cv::Mat headers which share the cached pixels, i.e. no per-frame copy is made.
+//
+// Optionally the frames can be kept in a flat file of raw 8-bit pixels which is memory-mapped instead
+// of living on the heap. If that file already exists and was written for the same list of images,
+// decoding is skipped altogether.
+class FrameCache
+{
+public:
+    FrameCache() = default;
+    ~FrameCache();
+
+    FrameCache(const FrameCache &) = delete;
+    FrameCache &operator=(const FrameCache &) = delete;
+
+    // decode + grayscale-convert all images (or map them from rawCachePath). Returns false on failure.
+    bool load(const std::vector<std::string> &imgFilenames, const std::string &rawCachePath = "");
+
+    // all frames of a (finite) source, read ahead and decoded in parallel by a FramePrefetcher
+    bool load(FrameSource &source);
+
+    size_t size() const { return frames.size(); }
+    const cv::Mat &frame(size_t index) const { return frames[index]; }
+
+    bool isMapped() const { return mappedData != nullptr; }
+    double loadTime() const { return loadTimeSec; } // time spent in load() in seconds
+
+private:
+    bool decodeAll(const std::vector<std::string> &imgFilenames);
+    bool writeRawFile(const std::string &rawCachePath, unsigned long long listHash) const;
+    bool mapRawFile(const std::string &rawCachePath, unsigned long long listHash);
+    void unmap();
+
+    std::vector<cv::Mat> frames;
+    void *mappedData = nullptr;
+    size_t mappedSize = 0;
+    double loadTimeSec = 0.0;
+};
+
+#endif /* frameCache_hpp */
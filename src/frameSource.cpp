@@ -0,0 +1,414 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "frameSource.hpp"
+
+using namespace std;
+
+namespace
+{
+bool readFile(const string &path, vector<uchar> &bytes)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in)
+    {
+        return false;
+    }
+    streamsize size = in.tellg();
+    in.seekg(0);
+    bytes.resize((size_t)size);
+    return (bool)in.read(reinterpret_cast<char *>(bytes.data()), size);
+}
+
+// same conversion as FrameCache (colour decode + cvtColor), so both produce identical frames
+void decodeImage(SourceFrame &frame)
+{
+    cv::Mat img = cv::imdecode(frame.bytes, cv::IMREAD_COLOR);
+    if (img.empty())
+    {
+        cout << "FrameSource: could not decode " << frame.name << endl;
+        frame.gray.release();
+        return;
+    }
+    cv::Mat gray; // always a new matrix, the previous one may still be in use downstream
+    cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    frame.gray = gray;
+}
+
+bool isInteger(const string &s)
+{
+    size_t start = !s.empty() && s[0] == '-' ? 1 : 0;
+    if (start >= s.size())
+    {
+        return false;
+    }
+    for (size_t i = start; i < s.size(); ++i)
+    {
+        if (!isdigit((unsigned char)s[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+/* FrameSource */
+
+void FrameSource::decode(SourceFrame &) const
+{
+}
+
+bool FrameSource::read(cv::Mat &gray)
+{
+    SourceFrame frame;
+    if (!fetch(frame))
+    {
+        return false;
+    }
+    decode(frame);
+    gray = frame.gray;
+    return !gray.empty();
+}
+
+/* ImageSequenceSource */
+
+ImageSequenceSource::ImageSequenceSource(const string &pattern, int firstIndex, int lastIndex)
+    : pattern(pattern), bValidPattern(isValidPattern(pattern)), nextIndex(firstIndex), lastIndex(lastIndex)
+{
+}
+
+bool ImageSequenceSource::isValidPattern(const string &pattern)
+{
+    int numConversions = 0;
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] != '%')
+        {
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+        {
+            ++i;
+            continue;
+        }
+        size_t j = i + 1;
+        while (j < pattern.size() && strchr("0-+ ", pattern[j]))
+        {
+            ++j;
+        }
+        while (j < pattern.size() && isdigit((unsigned char)pattern[j]))
+        {
+            ++j;
+        }
+        if (j >= pattern.size() || pattern[j] != 'd')
+        {
+            return false;
+        }
+        ++numConversions;
+        i = j;
+    }
+    return numConversions == 1;
+}
+
+bool ImageSequenceSource::fetch(SourceFrame &frame)
+{
+    if (!bValidPattern || (lastIndex >= 0 && nextIndex > lastIndex))
+    {
+        return false;
+    }
+    // (the pattern has been checked, so it is a safe format string; sized for any field width)
+    vector<char> name(snprintf(nullptr, 0, pattern.c_str(), nextIndex) + 1);
+    snprintf(name.data(), name.size(), pattern.c_str(), nextIndex);
+    frame.name = name.data();
+    if (!readFile(frame.name, frame.bytes))
+    {
+        if (lastIndex >= 0)
+        {
+            cout << "FrameSource: could not read " << frame.name << endl;
+        }
+        return false; // open ended sequences stop at the first missing file
+    }
+    frame.index = numFetched++;
+    ++nextIndex;
+    return true;
+}
+
+void ImageSequenceSource::decode(SourceFrame &frame) const
+{
+    decodeImage(frame);
+}
+
+/* ImageGlobSource */
+
+ImageGlobSource::ImageGlobSource(const string &pattern)
+{
+    cv::glob(pattern, files, false); // sorted
+}
+
+bool ImageGlobSource::fetch(SourceFrame &frame)
+{
+    while (next < files.size())
+    {
+        frame.name = files[next];
+        frame.index = next++;
+        if (readFile(frame.name, frame.bytes))
+        {
+            return true;
+        }
+        cout << "FrameSource: could not read " << frame.name << ", skipped" << endl;
+    }
+    return false;
+}
+
+void ImageGlobSource::decode(SourceFrame &frame) const
+{
+    decodeImage(frame);
+}
+
+/* VideoSource */
+
+VideoSource::VideoSource(const string &path) : capture(path), path(path)
+{
+    if (!capture.isOpened())
+    {
+        cout << "FrameSource: could not open video " << path << endl;
+    }
+}
+
+bool VideoSource::fetch(SourceFrame &frame)
+{
+    cv::Mat img;
+    if (!capture.isOpened() || !capture.read(img) || img.empty())
+    {
+        return false;
+    }
+    if (img.channels() == 3)
+    {
+        cv::Mat gray;
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+        frame.gray = gray;
+    }
+    else
+    {
+        frame.gray = img;
+    }
+    frame.index = numFetched++;
+    frame.name = path + "#" + to_string(frame.index);
+    frame.bytes.clear();
+    return true;
+}
+
+/* RawStreamSource */
+
+RawStreamSource::RawStreamSource(const string &path, int width, int height) : width(width), height(height)
+{
+    if (path == "-")
+    {
+        file = stdin;
+    }
+    else
+    {
+        file = fopen(path.c_str(), "rb");
+        bOwnsFile = file != nullptr;
+        if (!file)
+        {
+            cout << "FrameSource: could not open " << path << endl;
+        }
+    }
+}
+
+RawStreamSource::~RawStreamSource()
+{
+    if (bOwnsFile)
+    {
+        fclose(file);
+    }
+}
+
+bool RawStreamSource::fetch(SourceFrame &frame)
+{
+    if (!file || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+    cv::Mat gray(height, width, CV_8U); // new pixels, the previous frame may still be in use downstream
+    size_t numBytes = (size_t)width * height;
+    if (fread(gray.data, 1, numBytes, file) != numBytes)
+    {
+        return false; // end of the stream (a trailing partial frame is dropped)
+    }
+    frame.gray = gray;
+    frame.index = numFetched++;
+    frame.name = "raw#" + to_string(frame.index);
+    frame.bytes.clear();
+    return true;
+}
+
+/* FrameCacheSource */
+
+bool FrameCacheSource::fetch(SourceFrame &frame)
+{
+    if (next >= cache.size())
+    {
+        return false;
+    }
+    frame.index = next;
+    frame.name = "cache#" + to_string(next);
+    frame.gray = cache.frame(next++);
+    frame.bytes.clear();
+    return true;
+}
+
+/* factory */
+
+unique_ptr<FrameSource> createFrameSource(const string &spec)
+{
+    size_t colon = spec.find(':');
+    string kind = spec.substr(0, colon), arg = colon == string::npos ? "" : spec.substr(colon + 1);
+    if (kind == "seq" && !arg.empty())
+    {   // trailing ":first[:last]" fields, the pattern itself may contain colons
+        // (checked below: the pattern becomes a printf format string)
+        vector<int> numbers;
+        for (int k = 0; k < 2; ++k)
+        {
+            size_t pos = arg.rfind(':');
+            if (pos == string::npos || !isInteger(arg.substr(pos + 1)))
+            {
+                break;
+            }
+            numbers.insert(numbers.begin(), atoi(arg.substr(pos + 1).c_str()));
+            arg = arg.substr(0, pos);
+        }
+        int first = numbers.size() > 0 ? numbers[0] : 0;
+        int last = numbers.size() > 1 ? numbers[1] : -1;
+        if (ImageSequenceSource::isValidPattern(arg))
+        {
+            return unique_ptr<FrameSource>(new ImageSequenceSource(arg, first, last));
+        }
+        cout << "FrameSource: " << arg << " needs exactly one %d conversion for the frame index (write % as %%)" << endl;
+        return nullptr;
+    }
+    if (kind == "glob" && !arg.empty())
+    {
+        return unique_ptr<FrameSource>(new ImageGlobSource(arg));
+    }
+    if (kind == "video" && !arg.empty())
+    {
+        return unique_ptr<FrameSource>(new VideoSource(arg));
+    }
+    if (kind == "raw")
+    {
+        size_t pos = arg.rfind(':');
+        int width = 0, height = 0;
+        if (pos != string::npos && sscanf(arg.c_str() + pos + 1, "%dx%d", &width, &height) == 2 && width > 0 && height > 0)
+        {
+            return unique_ptr<FrameSource>(new RawStreamSource(arg.substr(0, pos), width, height));
+        }
+    }
+    cout << "FrameSource: invalid source " << spec << " (seq:<pattern>[:first[:last]], glob:<pattern>, video:<path>,"
+         << " raw:<path or ->:<width>x<height>)" << endl;
+    return nullptr;
+}
+
+/* FramePrefetcher */
+
+FramePrefetcher::FramePrefetcher(FrameSource &source, size_t numDecodeThreads, size_t capacity)
+    : source(source), slots(max<size_t>(1, capacity)), states(slots.size(), SLOT_FREE),
+      decodePool(max<size_t>(1, numDecodeThreads))
+{
+    reader = thread(&FramePrefetcher::readerLoop, this);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        bStop = true;
+    }
+    changed.notify_all();
+    reader.join();
+    try
+    {
+        decodePool.wait(); // decode tasks still write into the slots
+    }
+    catch (...)
+    {
+    }
+}
+
+void FramePrefetcher::readerLoop()
+{
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(mtx);
+            changed.wait(lock, [&]() { return bStop || states[writePos] == SLOT_FREE; });
+            if (bStop)
+            {
+                return;
+            }
+        }
+        // the slot is free, so neither the consumer nor a decode task touches it
+        size_t pos = writePos;
+        writePos = (writePos + 1) % slots.size();
+        bool bFetched = source.fetch(slots[pos]);
+        {
+            lock_guard<mutex> lock(mtx);
+            states[pos] = bFetched ? SLOT_DECODING : SLOT_END;
+        }
+        if (!bFetched)
+        {
+            changed.notify_all();
+            return;
+        }
+        decodePool.submit([this, pos]() {
+            try
+            {
+                source.decode(slots[pos]);
+            }
+            catch (const cv::Exception &e)
+            {
+                cout << "FrameSource: could not decode " << slots[pos].name << ": " << e.what() << endl;
+                slots[pos].gray.release();
+            }
+            {
+                lock_guard<mutex> lock(mtx);
+                states[pos] = SLOT_READY;
+            }
+            changed.notify_all();
+        });
+    }
+}
+
+bool FramePrefetcher::fetch(SourceFrame &frame)
+{
+    {
+        unique_lock<mutex> lock(mtx);
+        if (states[readPos] != SLOT_READY && states[readPos] != SLOT_END)
+        {
+            ++numConsumerWaits;
+            changed.wait(lock, [&]() { return states[readPos] == SLOT_READY || states[readPos] == SLOT_END; });
+        }
+        if (states[readPos] == SLOT_END)
+        {
+            return false; // stays at the end marker, later calls return false too
+        }
+    }
+    // swap rather than move: the slot gets the caller's old buffers to fill again
+    swap(frame, slots[readPos]);
+    {
+        lock_guard<mutex> lock(mtx);
+        states[readPos] = SLOT_FREE;
+    }
+    readPos = (readPos + 1) % slots.size();
+    changed.notify_all();
+    return true; // a frame which failed to decode has an empty gray, read() ends the stream there
+}
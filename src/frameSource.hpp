@@ -0,0 +1,156 @@
+#ifndef frameSource_hpp
+#define frameSource_hpp
+
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "frameCache.hpp"
+#include "threadPool.hpp"
+
+
+// one frame on its way from a source to the pipeline: fetch() fills bytes (or gray directly), decode() gray
+struct SourceFrame
+{
+    size_t index = 0;
+    std::string name;         // file name or "<source>#index", for messages
+    std::vector<uchar> bytes; // encoded file content, empty for sources which produce pixels directly
+    cv::Mat gray;             // 8-bit grayscale frame, empty if decoding failed
+};
+
+// Input of the tracker. Reading is split in two, so a FramePrefetcher can overlap them with processing:
+// fetch() does the sequential part (file / device I/O) and runs on one thread only, decode() turns the
+// fetched bytes into the grayscale frame and may run on any number of threads at once.
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    // next frame of the stream; false at its end
+    virtual bool fetch(SourceFrame &frame) = 0;
+    // thread-safe; the default is for sources whose fetch() already sets gray
+    virtual void decode(SourceFrame &frame) const;
+
+    // fetch + decode on the calling thread; false at the end of the stream or if the frame cannot be decoded
+    bool read(cv::Mat &gray);
+};
+
+// numbered images from a printf pattern, e.g. ".../data/%010d.png"; lastIndex < 0 = until a file is missing.
+// A pattern which isValidPattern() rejects gives an empty sequence.
+class ImageSequenceSource : public FrameSource
+{
+public:
+    ImageSequenceSource(const std::string &pattern, int firstIndex, int lastIndex = -1);
+    bool fetch(SourceFrame &frame) override;
+    void decode(SourceFrame &frame) const override;
+
+    // exactly one integer conversion (%d with optional flags and width), any other '%' escaped as %%
+    static bool isValidPattern(const std::string &pattern);
+
+private:
+    std::string pattern;
+    bool bValidPattern;
+    int nextIndex, lastIndex;
+    size_t numFetched = 0;
+};
+
+// all files matching a wildcard pattern (cv::glob), in sorted order
+class ImageGlobSource : public FrameSource
+{
+public:
+    explicit ImageGlobSource(const std::string &pattern);
+    bool fetch(SourceFrame &frame) override;
+    void decode(SourceFrame &frame) const override;
+
+private:
+    std::vector<cv::String> files;
+    size_t next = 0;
+};
+
+// video file (or anything else cv::VideoCapture opens); the codec decodes in fetch(), it is sequential anyway
+class VideoSource : public FrameSource
+{
+public:
+    explicit VideoSource(const std::string &path);
+    bool fetch(SourceFrame &frame) override;
+
+private:
+    cv::VideoCapture capture;
+    std::string path;
+    size_t numFetched = 0;
+};
+
+// raw 8-bit grayscale frames of width x height, back to back, from a file, a pipe or stdin ("-")
+class RawStreamSource : public FrameSource
+{
+public:
+    RawStreamSource(const std::string &path, int width, int height);
+    ~RawStreamSource();
+    bool fetch(SourceFrame &frame) override;
+
+private:
+    FILE *file = nullptr;
+    bool bOwnsFile = false;
+    int width, height;
+    size_t numFetched = 0;
+};
+
+// frames of a FrameCache, as a source (no I/O, no copy)
+class FrameCacheSource : public FrameSource
+{
+public:
+    explicit FrameCacheSource(const FrameCache &cache) : cache(cache) {}
+    bool fetch(SourceFrame &frame) override;
+
+private:
+    const FrameCache &cache;
+    size_t next = 0;
+};
+
+// Creates a source from a command line spec: "seq:<printf pattern>[:first[:last]]", "glob:<pattern>",
+// "video:<path>" or "raw:<path or ->:<width>x<height>". nullptr (and a message) if the spec is invalid.
+std::unique_ptr<FrameSource> createFrameSource(const std::string &spec);
+
+// Reads a source ahead of its consumer: a reader thread fetches up to capacity frames in advance and a small
+// pool decodes them concurrently, so disk I/O and decoding overlap with processing and the consumer only
+// waits if the source cannot keep up. Frames come out in stream order. Itself a FrameSource, so it can be
+// handed to anything that reads one (the consumer side is meant for a single thread).
+class FramePrefetcher : public FrameSource
+{
+public:
+    FramePrefetcher(FrameSource &source, size_t numDecodeThreads = 2, size_t capacity = 8);
+    ~FramePrefetcher();
+
+    FramePrefetcher(const FramePrefetcher &) = delete;
+    FramePrefetcher &operator=(const FramePrefetcher &) = delete;
+
+    bool fetch(SourceFrame &frame) override;
+
+    size_t consumerWaits() const { return numConsumerWaits; } // times the consumer found no decoded frame ready
+
+private:
+    enum SlotState { SLOT_FREE, SLOT_DECODING, SLOT_READY, SLOT_END };
+
+    void readerLoop();
+
+    FrameSource &source;
+    std::vector<SourceFrame> slots;
+    std::vector<SlotState> states;
+    size_t readPos = 0;  // next slot the consumer takes (consumer only)
+    size_t writePos = 0; // next slot the reader fills (reader only)
+    bool bStop = false;
+    size_t numConsumerWaits = 0;
+
+    std::mutex mtx; // guards states and bStop
+    std::condition_variable changed;
+    ThreadPool decodePool;
+    std::thread reader;
+};
+
+#endif /* frameSource_hpp */
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <opencv2/calib3d.hpp>
+
+#include "geometricVerifier.hpp"
+
+using namespace std;
+
+namespace
+{
+// Hartley normalization (centroid to the origin, mean distance sqrt(2)) of the points at offset 0 (query) or
+// 2 (train) of the [xq, yq, xt, yt] rows, so the minimal solvers see well conditioned coordinates
+cv::Matx33d normalizingTransform(const vector<float> &pts, int offset, int n)
+{
+    double cx = 0.0, cy = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        cx += pts[4 * i + offset];
+        cy += pts[4 * i + offset + 1];
+    }
+    cx /= n;
+    cy /= n;
+    double meanDist = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        meanDist += hypot(pts[4 * i + offset] - cx, pts[4 * i + offset + 1] - cy);
+    }
+    meanDist /= n;
+    double s = meanDist > 0.0 ? sqrt(2.0) / meanDist : 1.0;
+    return cv::Matx33d(s, 0.0, -s * cx, 0.0, s, -s * cy, 0.0, 0.0, 1.0);
+}
+
+// homography through the 4 sampled (normalized) correspondences, h33 = 1
+bool fitHomography(const vector<float> &norm, const int *sample, cv::Matx33d &H)
+{
+    cv::Matx<double, 8, 8> A;
+    cv::Matx<double, 8, 1> b, h;
+    for (int k = 0; k < 4; ++k)
+    {
+        const float *row = &norm[4 * sample[k]];
+        double x = row[0], y = row[1], u = row[2], v = row[3];
+        double r0[8] = {x, y, 1.0, 0.0, 0.0, 0.0, -u * x, -u * y};
+        double r1[8] = {0.0, 0.0, 0.0, x, y, 1.0, -v * x, -v * y};
+        for (int c = 0; c < 8; ++c)
+        {
+            A(2 * k, c) = r0[c];
+            A(2 * k + 1, c) = r1[c];
+        }
+        b(2 * k) = u;
+        b(2 * k + 1) = v;
+    }
+    if (!cv::solve(A, b, h, cv::DECOMP_LU)) // collinear sample
+    {
+        return false;
+    }
+    H = cv::Matx33d(h(0), h(1), h(2), h(3), h(4), h(5), h(6), h(7), 1.0);
+    return true;
+}
+
+// 1 or 3 fundamental matrices through the 7 sampled (normalized) correspondences, as rows of 3 in models
+int fitFundamental(const vector<float> &norm, const int *sample, cv::Mat &models)
+{
+    float q[14], t[14];
+    for (int k = 0; k < 7; ++k)
+    {
+        const float *row = &norm[4 * sample[k]];
+        q[2 * k] = row[0];
+        q[2 * k + 1] = row[1];
+        t[2 * k] = row[2];
+        t[2 * k + 1] = row[3];
+    }
+    models = cv::findFundamentalMat(cv::Mat(7, 1, CV_32FC2, q), cv::Mat(7, 1, CV_32FC2, t), cv::FM_7POINT);
+    return models.rows / 3;
+}
+
+// No. of the ranked correspondences within thresholdSq of the model (transfer error for a homography, Sampson
+// distance for a fundamental matrix). Without a mask it gives up once the count can no longer exceed best.
+int countInliers(const cv::Matx33d &M, bool bHomography, const vector<float> &pts, int n, double thresholdSq,
+                 int best, uchar *mask)
+{
+    int numInliers = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!mask && numInliers + (n - i) <= best)
+        {
+            break;
+        }
+        const float *row = &pts[4 * i];
+        double x = row[0], y = row[1], u = row[2], v = row[3];
+        double err;
+        if (bHomography)
+        {
+            double w = M(2, 0) * x + M(2, 1) * y + M(2, 2);
+            if (fabs(w) < 1e-12)
+            {
+                err = thresholdSq + 1.0;
+            }
+            else
+            {
+                double du = (M(0, 0) * x + M(0, 1) * y + M(0, 2)) / w - u;
+                double dv = (M(1, 0) * x + M(1, 1) * y + M(1, 2)) / w - v;
+                err = du * du + dv * dv;
+            }
+        }
+        else
+        {
+            double fx0 = M(0, 0) * x + M(0, 1) * y + M(0, 2);
+            double fx1 = M(1, 0) * x + M(1, 1) * y + M(1, 2);
+            double fx2 = M(2, 0) * x + M(2, 1) * y + M(2, 2);
+            double ft0 = M(0, 0) * u + M(1, 0) * v + M(2, 0);
+            double ft1 = M(0, 1) * u + M(1, 1) * v + M(2, 1);
+            double e = u * fx0 + v * fx1 + fx2;
+            double denom = fx0 * fx0 + fx1 * fx1 + ft0 * ft0 + ft1 * ft1;
+            err = denom > 0.0 ? e * e / denom : thresholdSq + 1.0;
+        }
+        bool bInlier = err <= thresholdSq;
+        numInliers += bInlier;
+        if (mask)
+        {
+            mask[i] = bInlier;
+        }
+    }
+    return numInliers;
+}
+} // namespace
+
+bool isVerifyModel(const string &model)
+{
+    return model.compare("HOMOGRAPHY") == 0 || model.compare("FUNDAMENTAL") == 0;
+}
+
+bool verifyMatches(const vector<cv::KeyPoint> &kptsQuery, const vector<cv::KeyPoint> &kptsTrain,
+                   const vector<cv::DMatch> &matches, vector<uchar> &inlierMask, const VerifyParams &params,
+                   cv::Mat *model, VerifyStats *stats, FrameArena *scratch)
+{
+    VerifyStats localStats;
+    VerifyStats &st = stats ? *stats : localStats;
+    st = VerifyStats();
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    bool bHomography = params.model.compare("HOMOGRAPHY") == 0;
+    const int m = bHomography ? 4 : 7; // minimal sample
+    const int n = (int)matches.size();
+    if (n < m || !isVerifyModel(params.model))
+    {
+        inlierMask.assign(n, 1);
+        return false;
+    }
+    inlierMask.assign(n, 0);
+
+    // #1 : rank the matches by descriptor distance, best first, and lay out their coordinates in that order
+    vector<int> &order = arena.ints.acquire();
+    order.resize(n);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return matches[a].distance < matches[b].distance; });
+    vector<float> &pts = arena.floats.acquire();
+    pts.resize(4 * n);
+    for (int i = 0; i < n; ++i)
+    {
+        const cv::DMatch &match = matches[order[i]];
+        const cv::Point2f &q = kptsQuery[match.queryIdx].pt, &t = kptsTrain[match.trainIdx].pt;
+        float *row = &pts[4 * i];
+        row[0] = q.x;
+        row[1] = q.y;
+        row[2] = t.x;
+        row[3] = t.y;
+    }
+    cv::Matx33d Tq = normalizingTransform(pts, 0, n), Tt = normalizingTransform(pts, 2, n);
+    cv::Matx33d TtInv = Tt.inv();
+    vector<float> &norm = arena.floats.acquire();
+    norm.resize(4 * n);
+    for (int i = 0; i < 4 * n; i += 4)
+    {
+        norm[i] = (float)(Tq(0, 0) * pts[i] + Tq(0, 2));
+        norm[i + 1] = (float)(Tq(1, 1) * pts[i + 1] + Tq(1, 2));
+        norm[i + 2] = (float)(Tt(0, 0) * pts[i + 2] + Tt(0, 2));
+        norm[i + 3] = (float)(Tt(1, 1) * pts[i + 3] + Tt(1, 2));
+    }
+
+    // #2 : PROSAC (Chum & Matas 2005). Tn is the expected no. of samples of a RANSAC run of maxIterations
+    // drawn from the n best ranked matches only; the sampling set grows by the next ranked match whenever
+    // the iteration count passes TnPrime, and until then every sample contains its newest (n-th) match.
+    const double thresholdSq = params.threshold * params.threshold;
+    const double confidence = min(max(params.confidence, 0.5), 0.9999);
+    const int maxIterations = max(1, params.maxIterations);
+    double Tn = maxIterations;
+    for (int i = 0; i < m; ++i)
+    {
+        Tn *= (double)(m - i) / (n - i);
+    }
+    double TnPrime = 1.0;
+    int setSize = m;
+    int limit = maxIterations;
+    cv::RNG rng(0x5eed); // fixed seed: the same matches always give the same model
+    cv::Matx33d bestModel;
+    int bestInliers = 0;
+    cv::Mat fundamentals;
+    int sample[7];
+    int iteration = 0;
+    while (iteration < limit)
+    {
+        ++iteration;
+        if (iteration > TnPrime && setSize < n)
+        {
+            double TnNext = Tn * (setSize + 1) / (setSize + 1 - m);
+            TnPrime += ceil(TnNext - Tn);
+            Tn = TnNext;
+            ++setSize;
+        }
+        bool bWithNewest = iteration <= TnPrime;
+        int numDrawn = bWithNewest ? m - 1 : m;
+        int poolSize = bWithNewest ? setSize - 1 : setSize;
+        for (int k = 0; k < numDrawn; ++k)
+        {
+            int idx;
+            do
+            {
+                idx = rng.uniform(0, poolSize);
+            } while (find(sample, sample + k, idx) != sample + k);
+            sample[k] = idx;
+        }
+        if (bWithNewest)
+        {
+            sample[m - 1] = setSize - 1;
+        }
+
+        // hypotheses in pixel coordinates
+        cv::Matx33d hypotheses[3];
+        int numHypotheses = 0;
+        if (bHomography)
+        {
+            cv::Matx33d H;
+            if (fitHomography(norm, sample, H))
+            {
+                hypotheses[numHypotheses++] = TtInv * H * Tq;
+            }
+        }
+        else
+        {
+            int numSolutions = fitFundamental(norm, sample, fundamentals);
+            for (int s = 0; s < numSolutions && s < 3; ++s)
+            {
+                cv::Matx33d F(fundamentals.ptr<double>(3 * s));
+                hypotheses[numHypotheses++] = Tt.t() * F * Tq;
+            }
+        }
+        for (int h = 0; h < numHypotheses; ++h)
+        {
+            int numInliers = countInliers(hypotheses[h], bHomography, pts, n, thresholdSq, bestInliers, nullptr);
+            if (numInliers > bestInliers)
+            {   // adaptive stop: enough iterations to draw an all-inlier sample at this inlier ratio
+                bestInliers = numInliers;
+                bestModel = hypotheses[h];
+                // log1p keeps log(1 - w^m) from rounding to 0 (and the bound to infinity) at low inlier ratios
+                double pInlierSample = pow((double)bestInliers / n, m);
+                double logOutlierSample = log1p(-pInlierSample);
+                if (pInlierSample >= 1.0)
+                {
+                    limit = iteration;
+                }
+                else if (logOutlierSample < 0.0)
+                {
+                    limit = (int)min((double)maxIterations, ceil(log1p(-confidence) / logOutlierSample));
+                }
+            }
+        }
+    }
+    st.numIterations = iteration;
+    if (bestInliers < m)
+    {
+        return false;
+    }
+
+    // #3 : refit to all inliers (least squares) and keep the refit unless it explains fewer matches
+    vector<uchar> &ranked = arena.bytes.acquire();
+    ranked.resize(n);
+    countInliers(bestModel, bHomography, pts, n, thresholdSq, -1, ranked.data());
+    if (bestInliers >= (bHomography ? 4 : 8))
+    {
+        vector<float> &inlierQuery = arena.floats.acquire(), &inlierTrain = arena.floats.acquire();
+        for (int i = 0; i < n; ++i)
+        {
+            if (ranked[i])
+            {
+                inlierQuery.insert(inlierQuery.end(), &pts[4 * i], &pts[4 * i] + 2);
+                inlierTrain.insert(inlierTrain.end(), &pts[4 * i] + 2, &pts[4 * i] + 4);
+            }
+        }
+        cv::Mat q(bestInliers, 1, CV_32FC2, inlierQuery.data()), t(bestInliers, 1, CV_32FC2, inlierTrain.data());
+        cv::Mat refit = bHomography ? cv::findHomography(q, t, 0) : cv::findFundamentalMat(q, t, cv::FM_8POINT);
+        if (refit.rows == 3 && refit.cols == 3 && refit.type() == CV_64F)
+        {
+            cv::Matx33d refined(refit.ptr<double>());
+            int numRefined = countInliers(refined, bHomography, pts, n, thresholdSq, -1, nullptr);
+            if (numRefined >= bestInliers)
+            {
+                bestModel = refined;
+                bestInliers = countInliers(bestModel, bHomography, pts, n, thresholdSq, -1, ranked.data());
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        inlierMask[order[i]] = ranked[i];
+    }
+    st.bModelFound = true;
+    st.numInliers = bestInliers;
+    if (model)
+    {
+        *model = cv::Mat(bestModel, true);
+    }
+    return true;
+}
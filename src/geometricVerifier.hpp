@@ -0,0 +1,43 @@
+#ifndef geometricVerifier_hpp
+#define geometricVerifier_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include "frameArena.hpp"
+
+
+struct VerifyParams
+{
+    std::string model = "HOMOGRAPHY"; // HOMOGRAPHY (planar scene / rotating camera) or FUNDAMENTAL (general motion)
+    double threshold = 3.0;           // inlier distance in px: transfer error (HOMOGRAPHY), Sampson distance (FUNDAMENTAL)
+    double confidence = 0.99;         // stop once a model with more inliers is this unlikely to be missed
+    int maxIterations = 1000;         // hypotheses at most
+};
+
+struct VerifyStats
+{
+    bool bModelFound = false;
+    int numIterations = 0; // hypotheses drawn
+    int numInliers = 0;
+};
+
+// Geometric verification of putative matches (queryIdx into kptsQuery, trainIdx into kptsTrain) with PROSAC:
+// the matches are ranked by DMatch::distance and the minimal samples are drawn from a progressively growing
+// set of the best ranked ones, so with ratio-tested matches the first hypotheses are mostly outlier-free and
+// the adaptive RANSAC bound ends the search after a handful of iterations. Scoring a hypothesis stops as soon
+// as it cannot beat the best one any more; the winner is refitted to all its inliers (least squares).
+// inlierMask gets one entry per match (1 = consistent with the model). With fewer matches than a minimal
+// sample there is nothing to verify: the mask is all 1 and false is returned, as it is when no model is found
+// (then all 0) or when params.model is not a known model (then all 1). model (optional) receives the 3x3
+// homography / fundamental matrix (CV_64F).
+bool verifyMatches(const std::vector<cv::KeyPoint> &kptsQuery, const std::vector<cv::KeyPoint> &kptsTrain,
+                   const std::vector<cv::DMatch> &matches, std::vector<uchar> &inlierMask, const VerifyParams &params,
+                   cv::Mat *model = nullptr, VerifyStats *stats = nullptr, FrameArena *scratch = nullptr);
+
+// true for the models verifyMatches can fit: HOMOGRAPHY and FUNDAMENTAL
+bool isVerifyModel(const std::string &model);
+
+#endif /* geometricVerifier_hpp */
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <opencv2/core/hal/hal.hpp>
+
+#include "gridMatcher.hpp"
+#include "quantizedMatcher.hpp"
+
+using namespace std;
+
+namespace
+{
+// keypoint indices bucketed by position into cells of cellSize x cellSize px, stored in buffers of the arena
+class KeypointGrid
+{
+public:
+    KeypointGrid(const vector<cv::KeyPoint> &keypoints, float cellSize, FrameArena &scratch)
+        : cellSize(cellSize > 0.0f ? cellSize : 1.0f), // the cell index divides by it
+          cellStart(scratch.ints.acquire()), indices(scratch.ints.acquire())
+    {
+        minX = minY = numeric_limits<float>::max();
+        float maxX = -numeric_limits<float>::max(), maxY = -numeric_limits<float>::max();
+        for (const cv::KeyPoint &kp : keypoints)
+        {
+            minX = min(minX, kp.pt.x);
+            minY = min(minY, kp.pt.y);
+            maxX = max(maxX, kp.pt.x);
+            maxY = max(maxY, kp.pt.y);
+        }
+        if (keypoints.empty())
+        {
+            minX = minY = maxX = maxY = 0.0f;
+        }
+        cols = (int)((maxX - minX) / this->cellSize) + 1;
+        rows = (int)((maxY - minY) / this->cellSize) + 1;
+
+        // counting sort into a flat index array (CSR layout)
+        cellStart.assign(cols * rows + 1, 0);
+        for (const cv::KeyPoint &kp : keypoints)
+        {
+            ++cellStart[cellOf(kp.pt) + 1];
+        }
+        for (size_t c = 1; c < cellStart.size(); ++c)
+        {
+            cellStart[c] += cellStart[c - 1];
+        }
+        indices.resize(keypoints.size());
+        vector<int> &next = scratch.ints.acquire();
+        next.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < keypoints.size(); ++i)
+        {
+            indices[next[cellOf(keypoints[i].pt)]++] = (int)i;
+        }
+    }
+
+    // calls visit(idx) for every keypoint in the cells overlapping the square [center - radius, center + radius]
+    template <typename Visit>
+    void forEachNear(cv::Point2f center, float radius, Visit visit) const
+    {
+        int c0 = max(0, (int)floor((center.x - radius - minX) / cellSize));
+        int c1 = min(cols - 1, (int)floor((center.x + radius - minX) / cellSize));
+        int r0 = max(0, (int)floor((center.y - radius - minY) / cellSize));
+        int r1 = min(rows - 1, (int)floor((center.y + radius - minY) / cellSize));
+        for (int r = r0; r <= r1; ++r)
+        {
+            for (int c = c0; c <= c1; ++c)
+            {
+                int cell = r * cols + c;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k)
+                {
+                    visit(indices[k]);
+                }
+            }
+        }
+    }
+
+private:
+    int cellOf(cv::Point2f pt) const
+    {
+        int c = min(cols - 1, max(0, (int)((pt.x - minX) / cellSize)));
+        int r = min(rows - 1, max(0, (int)((pt.y - minY) / cellSize)));
+        return r * cols + c;
+    }
+
+    float cellSize;
+    float minX, minY;
+    int cols, rows;
+    vector<int> &cellStart;
+    vector<int> &indices;
+};
+
+bool hasFlow(const cv::Point2f &flow)
+{
+    return !std::isnan(flow.x);
+}
+
+// component-wise median, values is reordered
+cv::Point2f medianFlow(vector<float> &xs, vector<float> &ys)
+{
+    size_t mid = xs.size() / 2;
+    nth_element(xs.begin(), xs.begin() + mid, xs.end());
+    nth_element(ys.begin(), ys.begin() + mid, ys.end());
+    return cv::Point2f(xs[mid], ys[mid]);
+}
+
+// squared L2 for float descriptors (also quantized to uint8) so the ratio test can compare squares; Hamming for
+// binary ones
+float descriptorDistance(const cv::Mat &descA, int rowA, const cv::Mat &descB, int rowB, int normType)
+{
+    if (normType == cv::NORM_HAMMING)
+    {
+        return (float)cv::hal::normHamming(descA.ptr<uchar>(rowA), descB.ptr<uchar>(rowB), descA.cols);
+    }
+    if (descA.depth() == CV_8U)
+    {
+        return (float)l2SqrU8(descA.ptr<uchar>(rowA), descB.ptr<uchar>(rowB), descA.cols);
+    }
+    return cv::hal::normL2Sqr_(descA.ptr<float>(rowA), descB.ptr<float>(rowB), descA.cols);
+}
+} // namespace
+
+void updateKeypointFlow(const vector<cv::KeyPoint> &prevKeypoints, DataFrame &currFrame)
+{
+    const float nan = numeric_limits<float>::quiet_NaN();
+    currFrame.kptFlow.assign(currFrame.keypoints.size(), cv::Point2f(nan, nan));
+    for (const cv::DMatch &match : currFrame.kptMatches)
+    {
+        currFrame.kptFlow[match.trainIdx] = currFrame.keypoints[match.trainIdx].pt - prevKeypoints[match.queryIdx].pt;
+    }
+}
+
+bool hasMotionSupport(const DataFrame &sourceFrame, const GridMatchParams &params)
+{
+    if (sourceFrame.kptFlow.size() != sourceFrame.keypoints.size())
+    {
+        return false;
+    }
+    int numMatched = (int)count_if(sourceFrame.kptFlow.begin(), sourceFrame.kptFlow.end(), hasFlow);
+    return numMatched >= params.minSupport;
+}
+
+void matchDescriptorsGated(const DataFrame &sourceFrame, const DataFrame &refFrame, vector<cv::DMatch> &matches,
+                           int normType, string selectorType, const GridMatchParams &params, GridMatchStats *stats,
+                           FrameArena *scratch)
+{
+    GridMatchStats localStats;
+    GridMatchStats &st = stats ? *stats : localStats;
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    const vector<cv::KeyPoint> &kPtsSource = sourceFrame.keypoints;
+    const vector<cv::KeyPoint> &kPtsRef = refFrame.keypoints;
+    bool bKnn = selectorType.compare("SEL_KNN") == 0;
+    bool bL2 = normType != cv::NORM_HAMMING;
+    const float minDescDistRatio = 0.8f;
+    const float ratio = bL2 ? minDescDistRatio * minDescDistRatio : minDescDistRatio; // L2 distances are squared
+
+    // #1 : predict where each source keypoint moves to (constant velocity)
+    bool bHaveFlow = sourceFrame.kptFlow.size() == kPtsSource.size();
+    vector<float> &xs = arena.floats.acquire(), &ys = arena.floats.acquire();
+    for (size_t i = 0; bHaveFlow && i < kPtsSource.size(); ++i)
+    {
+        if (hasFlow(sourceFrame.kptFlow[i]))
+        {
+            xs.push_back(sourceFrame.kptFlow[i].x);
+            ys.push_back(sourceFrame.kptFlow[i].y);
+        }
+    }
+    bool bGlobalSupport = (int)xs.size() >= params.minSupport;
+    cv::Point2f globalFlow = bGlobalSupport ? medianFlow(xs, ys) : cv::Point2f(0.0f, 0.0f);
+
+    KeypointGrid sourceGrid(kPtsSource, params.neighbourRadius, arena);
+    KeypointGrid refGrid(kPtsRef, params.cellSize, arena);
+    float searchRadiusSq = params.searchRadius * params.searchRadius;
+    float neighbourRadiusSq = params.neighbourRadius * params.neighbourRadius;
+
+    for (int q = 0; q < (int)kPtsSource.size(); ++q)
+    {
+        const cv::Point2f &pt = kPtsSource[q].pt;
+        cv::Point2f flow;
+        bool bPredicted = true;
+        if (bHaveFlow && hasFlow(sourceFrame.kptFlow[q]))
+        {
+            flow = sourceFrame.kptFlow[q];
+            ++st.numOwnPrediction;
+        }
+        else
+        {
+            xs.clear();
+            ys.clear();
+            if (bHaveFlow)
+            {
+                sourceGrid.forEachNear(pt, params.neighbourRadius, [&](int n) {
+                    cv::Point2f d = kPtsSource[n].pt - pt;
+                    if (hasFlow(sourceFrame.kptFlow[n]) && d.dot(d) <= neighbourRadiusSq)
+                    {
+                        xs.push_back(sourceFrame.kptFlow[n].x);
+                        ys.push_back(sourceFrame.kptFlow[n].y);
+                    }
+                });
+            }
+            if ((int)xs.size() >= params.minSupport)
+            {
+                flow = medianFlow(xs, ys);
+                ++st.numLocalPrediction;
+            }
+            else if (bGlobalSupport)
+            {
+                flow = globalFlow;
+                ++st.numGlobalPrediction;
+            }
+            else
+            {
+                bPredicted = false;
+                ++st.numUnpredicted;
+            }
+        }
+
+        // #2 : best two candidates, inside the search window or globally without prediction
+        float best = numeric_limits<float>::max(), second = numeric_limits<float>::max();
+        int bestIdx = -1;
+        auto consider = [&](int r) {
+            float d = descriptorDistance(sourceFrame.descriptors, q, refFrame.descriptors, r, normType);
+            ++st.numComparisons;
+            if (d < second)
+            {
+                if (d < best)
+                {
+                    second = best;
+                    best = d;
+                    bestIdx = r;
+                }
+                else
+                {
+                    second = d;
+                }
+            }
+        };
+        if (bPredicted)
+        {
+            cv::Point2f predicted = pt + flow;
+            refGrid.forEachNear(predicted, params.searchRadius, [&](int r) {
+                cv::Point2f d = kPtsRef[r].pt - predicted;
+                if (d.dot(d) <= searchRadiusSq)
+                {
+                    consider(r);
+                }
+            });
+        }
+        else
+        {
+            for (int r = 0; r < (int)kPtsRef.size(); ++r)
+            {
+                consider(r);
+            }
+        }
+
+        // #3 : selection; with a single candidate in the window the match is unambiguous for the ratio test
+        if (bestIdx < 0 || (bKnn && second != numeric_limits<float>::max() && !(best < ratio * second)))
+        {
+            continue;
+        }
+        if (bKnn && second == numeric_limits<float>::max() && !bPredicted)
+        {
+            continue; // global search with a single reference keypoint: same as knnMatch, no second neighbour
+        }
+        matches.push_back(cv::DMatch(q, bestIdx, bL2 ? sqrt(best) : best));
+    }
+}
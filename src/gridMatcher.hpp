@@ -0,0 +1,48 @@
+#ifndef gridMatcher_hpp
+#define gridMatcher_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+
+// Spatially gated matching: the reference keypoints are bucketed into a uniform grid and each source keypoint
+// is only compared with the reference keypoints inside a search window around its predicted position.
+// Predictions come from a constant velocity model on the displacements found by the previous match
+// (DataFrame::kptFlow): a keypoint's own displacement if it was matched, otherwise the median displacement of
+// its matched neighbours, otherwise the median over the whole frame. Keypoints without any support fall back
+// to a global search.
+struct GridMatchParams
+{
+    float cellSize = 16.0f;        // grid cell size in px
+    float searchRadius = 16.0f;    // radius of the search window around the prediction in px
+    float neighbourRadius = 48.0f; // neighbours within this radius support a prediction for unmatched keypoints
+    int minSupport = 3;            // min. no. of neighbours / matches needed for a median based prediction
+};
+
+struct GridMatchStats
+{
+    size_t numOwnPrediction = 0;    // keypoint carried its own displacement
+    size_t numLocalPrediction = 0;  // median of the neighbours' displacements
+    size_t numGlobalPrediction = 0; // median over the whole frame
+    size_t numUnpredicted = 0;      // searched globally
+    size_t numComparisons = 0;      // descriptor distances evaluated
+};
+
+// Sets currFrame.kptFlow from currFrame.kptMatches (queryIdx into prevKeypoints, trainIdx into currFrame.keypoints).
+// Unmatched keypoints get a NaN displacement.
+void updateKeypointFlow(const std::vector<cv::KeyPoint> &prevKeypoints, DataFrame &currFrame);
+
+// true if the source frame carries displacements which can drive the prediction
+bool hasMotionSupport(const DataFrame &sourceFrame, const GridMatchParams &params);
+
+// Gated matching of sourceFrame (query) against refFrame (train). selectorType is SEL_NN or SEL_KNN (k=2 with
+// distance ratio 0.8); normType is NORM_HAMMING for binary and NORM_L2 for float descriptors. The grids and
+// flow samples are built in scratch if given.
+void matchDescriptorsGated(const DataFrame &sourceFrame, const DataFrame &refFrame, std::vector<cv::DMatch> &matches,
+                           int normType, std::string selectorType, const GridMatchParams &params = GridMatchParams(),
+                           GridMatchStats *stats = nullptr, FrameArena *scratch = nullptr);
+
+#endif /* gridMatcher_hpp */
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#include "hammingMatcher.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAMMING_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+// no. of reference rows per tile: 256 x 64 byte = 16 KB, i.e. a tile of train descriptors stays in L1
+// while all query descriptors are streamed against it
+const int trainTileRows = 256;
+
+// Tiled 2-NN search shared by all kernels. DIST(a, b) is the Hamming distance of two rows; the running best
+// two distances of the current query live in locals for the whole tile. Written as a macro so the distance
+// kernel is inlined into each target-specific function (an inline template would cross target attributes).
+#define HAMMING_KNN2_TILED(DIST)                                                              \
+    for (int tileStart = 0; tileStart < numTrain; tileStart += trainTileRows)                 \
+    {                                                                                          \
+        int tileEnd = min(numTrain, tileStart + trainTileRows);                                \
+        for (int q = 0; q < numQuery; ++q)                                                     \
+        {                                                                                      \
+            const uchar *qRow = query + q * queryStride;                                       \
+            int best = bestDist[q], second = secondDist[q], idx = bestIdx[q];                  \
+            for (int t = tileStart; t < tileEnd; ++t)                                          \
+            {                                                                                  \
+                int d = DIST(qRow, train + t * trainStride);                                   \
+                if (d < second)                                                                \
+                {                                                                              \
+                    if (d < best)                                                              \
+                    {                                                                          \
+                        second = best;                                                         \
+                        best = d;                                                              \
+                        idx = t;                                                               \
+                    }                                                                          \
+                    else                                                                       \
+                    {                                                                          \
+                        second = d;                                                            \
+                    }                                                                          \
+                }                                                                              \
+            }                                                                                  \
+            bestDist[q] = best;                                                                \
+            secondDist[q] = second;                                                            \
+            bestIdx[q] = idx;                                                                  \
+        }                                                                                      \
+    }
+
+/* scalar */
+
+inline int hammingScalar(const uchar *a, const uchar *b, int descBytes)
+{
+    int dist = 0;
+    int i = 0;
+    for (; i + 8 <= descBytes; i += 8)
+    {
+        uint64_t wa, wb;
+        memcpy(&wa, a + i, 8);
+        memcpy(&wb, b + i, 8);
+        dist += __builtin_popcountll(wa ^ wb);
+    }
+    for (; i < descBytes; ++i)
+    {
+        dist += __builtin_popcount((unsigned)(a[i] ^ b[i]));
+    }
+    return dist;
+}
+
+void knn2Scalar(const uchar *query, size_t queryStride, int numQuery, const uchar *train, size_t trainStride,
+                int numTrain, int descBytes, int *bestIdx, int *bestDist, int *secondDist)
+{
+#define HAMMING_DIST_SCALAR(a, b) hammingScalar(a, b, descBytes)
+    HAMMING_KNN2_TILED(HAMMING_DIST_SCALAR)
+#undef HAMMING_DIST_SCALAR
+}
+
+#ifdef HAMMING_X86
+
+/* AVX2: per-byte popcount via a 4 bit lookup table, summed with SAD against zero */
+
+__attribute__((target("avx2"))) inline __m256i popcountBytesAvx2(__m256i v)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, lowMask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+}
+
+__attribute__((target("avx2"))) inline int sumBytesAvx2(__m256i counts)
+{
+    __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256()); // 4 x 64 bit partial sums
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    return _mm_cvtsi128_si32(s) + _mm_extract_epi32(s, 2);
+}
+
+__attribute__((target("avx2"))) inline int hamming32Avx2(const uchar *a, const uchar *b)
+{
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a), _mm256_loadu_si256((const __m256i *)b));
+    return sumBytesAvx2(popcountBytesAvx2(x));
+}
+
+__attribute__((target("avx2"))) inline int hamming64Avx2(const uchar *a, const uchar *b)
+{
+    __m256i x0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a), _mm256_loadu_si256((const __m256i *)b));
+    __m256i x1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + 32)), _mm256_loadu_si256((const __m256i *)(b + 32)));
+    // per-byte counts are <= 8, so adding the two halves before the SAD cannot overflow
+    return sumBytesAvx2(_mm256_add_epi8(popcountBytesAvx2(x0), popcountBytesAvx2(x1)));
+}
+
+__attribute__((target("avx2"))) void knn2Avx2(const uchar *query, size_t queryStride, int numQuery, const uchar *train,
+                                              size_t trainStride, int numTrain, int descBytes, int *bestIdx,
+                                              int *bestDist, int *secondDist)
+{
+    if (descBytes == 32)
+    {
+        HAMMING_KNN2_TILED(hamming32Avx2)
+    }
+    else
+    {
+        HAMMING_KNN2_TILED(hamming64Avx2)
+    }
+}
+
+/* AVX-512 VPOPCNTDQ: native 64 bit popcount on a whole 512 bit row */
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline int hamming32Avx512(const uchar *a, const uchar *b)
+{
+    __m512i x = _mm512_xor_si512(_mm512_maskz_loadu_epi64(0x0f, a), _mm512_maskz_loadu_epi64(0x0f, b));
+    return (int)_mm512_reduce_add_epi64(_mm512_popcnt_epi64(x));
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline int hamming64Avx512(const uchar *a, const uchar *b)
+{
+    __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a), _mm512_loadu_si512(b));
+    return (int)_mm512_reduce_add_epi64(_mm512_popcnt_epi64(x));
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) void knn2Avx512(const uchar *query, size_t queryStride, int numQuery,
+                                                                   const uchar *train, size_t trainStride, int numTrain,
+                                                                   int descBytes, int *bestIdx, int *bestDist,
+                                                                   int *secondDist)
+{
+    if (descBytes == 32)
+    {
+        HAMMING_KNN2_TILED(hamming32Avx512)
+    }
+    else
+    {
+        HAMMING_KNN2_TILED(hamming64Avx512)
+    }
+}
+
+#endif /* HAMMING_X86 */
+
+#undef HAMMING_KNN2_TILED
+} // namespace
+
+HammingKernel bestHammingKernel()
+{
+#ifdef HAMMING_X86
+    static const HammingKernel kernel = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq"))
+        {
+            return HAMMING_AVX512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return HAMMING_AVX2;
+        }
+        return HAMMING_SCALAR;
+    }();
+    return kernel;
+#else
+    return HAMMING_SCALAR;
+#endif
+}
+
+const char *hammingKernelName(HammingKernel kernel)
+{
+    switch (kernel)
+    {
+    case HAMMING_AVX512:
+        return "AVX-512 VPOPCNTDQ";
+    case HAMMING_AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+bool isHammingMatchable(const cv::Mat &descriptors)
+{
+    return descriptors.depth() == CV_8U && descriptors.channels() == 1 && descriptors.cols > 0 && descriptors.cols <= 64;
+}
+
+void hammingKnn2(const uchar *query, size_t queryStride, int numQuery, const uchar *train, size_t trainStride,
+                 int numTrain, int descBytes, int *bestIdx, int *bestDist, int *secondDist, HammingKernel kernel)
+{
+    fill(bestIdx, bestIdx + numQuery, -1);
+    fill(bestDist, bestDist + numQuery, INT_MAX);
+    fill(secondDist, secondDist + numQuery, INT_MAX);
+
+#ifdef HAMMING_X86
+    if (descBytes == 32 || descBytes == 64)
+    {
+        if (kernel == HAMMING_AVX512)
+        {
+            knn2Avx512(query, queryStride, numQuery, train, trainStride, numTrain, descBytes, bestIdx, bestDist, secondDist);
+            return;
+        }
+        if (kernel == HAMMING_AVX2)
+        {
+            knn2Avx2(query, queryStride, numQuery, train, trainStride, numTrain, descBytes, bestIdx, bestDist, secondDist);
+            return;
+        }
+    }
+#endif
+    knn2Scalar(query, queryStride, numQuery, train, trainStride, numTrain, descBytes, bestIdx, bestDist, secondDist);
+}
+
+void matchHammingKnnRatio(const cv::Mat &descSource, const cv::Mat &descRef, vector<cv::DMatch> &matches,
+                          float minDescDistRatio, FrameArena *scratch)
+{
+    CV_Assert(isHammingMatchable(descSource) && descSource.cols == descRef.cols && descSource.type() == descRef.type());
+    if (descSource.rows == 0 || descRef.rows == 0)
+    {
+        return;
+    }
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    cv::Mat query = descSource, train = descRef;
+    int descBytes = descSource.cols;
+    if (descBytes != 32 && descBytes != 64)
+    {   // e.g. AKAZE-MLDB (61 bytes): zero-pad both sides to 64 bytes, the padding XORs to zero
+        cv::Mat paddedQuery = arena.rows(descSource.rows, 64, CV_8U);
+        cv::Mat paddedTrain = arena.rows(descRef.rows, 64, CV_8U);
+        paddedQuery.setTo(0);
+        paddedTrain.setTo(0);
+        descSource.copyTo(paddedQuery.colRange(0, descBytes));
+        descRef.copyTo(paddedTrain.colRange(0, descBytes));
+        query = paddedQuery;
+        train = paddedTrain;
+        descBytes = 64;
+    }
+
+    vector<int> &bestIdx = arena.ints.acquire(), &bestDist = arena.ints.acquire(), &secondDist = arena.ints.acquire();
+    bestIdx.resize(query.rows);
+    bestDist.resize(query.rows);
+    secondDist.resize(query.rows);
+    hammingKnn2(query.ptr(), query.step, query.rows, train.ptr(), train.step, train.rows, descBytes,
+                bestIdx.data(), bestDist.data(), secondDist.data(), bestHammingKernel());
+
+    for (int q = 0; q < query.rows; ++q)
+    {
+        // a query without a second neighbour cannot pass the ratio test (same as knnMatch + filtering)
+        if (bestIdx[q] >= 0 && secondDist[q] != INT_MAX && bestDist[q] < minDescDistRatio * secondDist[q])
+        {
+            matches.push_back(cv::DMatch(q, bestIdx[q], (float)bestDist[q]));
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef hammingMatcher_hpp
+#define hammingMatcher_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "frameArena.hpp"
+
+
+// Brute-force 2-NN matcher for binary descriptors (ORB, BRIEF, BRISK, FREAK, AKAZE-MLDB) with the distance
+// ratio test fused into the search. Replaces BFMatcher(NORM_HAMMING)::knnMatch(k=2) + a second filtering
+// pass: no vector<vector<DMatch>> is materialized, the two best distances per query are tracked in
+// registers and the reference descriptors are processed in tiles which stay resident in L1/L2.
+// Popcount kernels are picked at runtime: AVX-512 VPOPCNTDQ, AVX2 (nibble LUT) or scalar popcnt.
+
+enum HammingKernel
+{
+    HAMMING_SCALAR,
+    HAMMING_AVX2,
+    HAMMING_AVX512
+};
+
+// fastest kernel supported by the CPU this runs on
+HammingKernel bestHammingKernel();
+const char *hammingKernelName(HammingKernel kernel);
+
+// true if matchHammingKnnRatio can handle the descriptor matrix (CV_8U, 1..64 bytes per row)
+bool isHammingMatchable(const cv::Mat &descriptors);
+
+// For every query row find the best and second best train row. Rows are descBytes long (32 or 64 for the
+// SIMD kernels, anything up to 64 for the scalar one); strides are in bytes. bestIdx is -1 if numTrain == 0,
+// secondDist is INT_MAX if numTrain < 2.
+void hammingKnn2(const uchar *query, size_t queryStride, int numQuery,
+                 const uchar *train, size_t trainStride, int numTrain, int descBytes,
+                 int *bestIdx, int *bestDist, int *secondDist, HammingKernel kernel);
+
+// k=2 nearest neighbour matching with distance ratio test: a match is kept if best < ratio * second.
+// The per-query results (and padded copies) live in scratch if given.
+void matchHammingKnnRatio(const cv::Mat &descSource, const cv::Mat &descRef, std::vector<cv::DMatch> &matches,
+                          float minDescDistRatio = 0.8f, FrameArena *scratch = nullptr);
+
+#endif /* hammingMatcher_hpp */
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <opencv2/features2d.hpp>
+
+#include "keypointBudget.hpp"
+
+using namespace std;
+
+namespace
+{
+// orders candidate indices strongest first, in place; equal responses keep their index order (a stable sort
+// without stable_sort's temporary buffer). Without response information this is the detector order.
+void rankKeypoints(const KeypointStore &keypoints, vector<int> &ranked)
+{
+    const float *response = keypoints.response.data();
+    bool bHaveResponse = false;
+    for (size_t i = 1; i < ranked.size() && !bHaveResponse; ++i)
+    {
+        bHaveResponse = response[ranked[i]] != response[ranked[0]];
+    }
+    if (bHaveResponse)
+    {
+        sort(ranked.begin(), ranked.end(), [&](int a, int b) {
+            return response[a] != response[b] ? response[a] > response[b] : a < b;
+        });
+    }
+}
+
+// round robin over grid buckets: the best keypoint of every bucket, then the second best of every bucket, ...
+// The buckets are a counting sort of the rank positions, so they stay sorted strongest first.
+void selectGrid(const KeypointStore &keypoints, const vector<int> &ranked, const cv::Rect &area,
+                const KeypointBudget &budget, FrameArena &scratch, vector<int> &selected)
+{
+    int gridCols = max(1, budget.gridCols), gridRows = max(1, budget.gridRows);
+    float cellWidth = max(1.0f, (float)area.width / gridCols), cellHeight = max(1.0f, (float)area.height / gridRows);
+    size_t numBuckets = (size_t)gridCols * gridRows;
+    vector<int> &bucketOf = scratch.ints.acquire();
+    vector<int> &bucketStart = scratch.ints.acquire();
+    bucketOf.resize(ranked.size());
+    bucketStart.assign(numBuckets + 1, 0);
+    for (size_t i = 0; i < ranked.size(); ++i)
+    {
+        int c = min(gridCols - 1, max(0, (int)((keypoints.x[ranked[i]] - area.x) / cellWidth)));
+        int r = min(gridRows - 1, max(0, (int)((keypoints.y[ranked[i]] - area.y) / cellHeight)));
+        bucketOf[i] = r * gridCols + c;
+        ++bucketStart[bucketOf[i] + 1];
+    }
+    for (size_t b = 0; b < numBuckets; ++b)
+    {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    vector<int> &bucketed = scratch.ints.acquire(); // rank positions, bucket after bucket
+    vector<int> &fill = scratch.ints.acquire();
+    bucketed.resize(ranked.size());
+    fill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < ranked.size(); ++i)
+    {
+        bucketed[fill[bucketOf[i]]++] = (int)i;
+    }
+
+    vector<int> &roundPicks = scratch.ints.acquire();
+    for (int round = 0; (int)selected.size() < budget.maxKeypoints; ++round)
+    {
+        roundPicks.clear();
+        for (size_t b = 0; b < numBuckets; ++b)
+        {
+            if (bucketStart[b] + round < bucketStart[b + 1])
+            {
+                roundPicks.push_back(bucketed[bucketStart[b] + round]);
+            }
+        }
+        if (roundPicks.empty())
+        {
+            break;
+        }
+        // if this round does not fit completely, its strongest keypoints win
+        sort(roundPicks.begin(), roundPicks.end());
+        size_t numTake = min(roundPicks.size(), (size_t)budget.maxKeypoints - selected.size());
+        for (size_t i = 0; i < numTake; ++i)
+        {
+            selected.push_back(ranked[roundPicks[i]]);
+        }
+    }
+}
+
+// adaptive non-maximal suppression (Brown et al.): keep the keypoints with the largest distance to the next
+// keypoint which is clearly (robustness factor 0.9) stronger
+void selectAnms(const KeypointStore &keypoints, const vector<int> &ranked, int maxKeypoints, FrameArena &scratch,
+                vector<int> &selected)
+{
+    // the suppression radius is O(n^2): weak candidates far down the ranking are never selected anyway
+    size_t numCandidates = min(ranked.size(), (size_t)maxKeypoints * 10);
+
+    const float *x = keypoints.x.data(), *y = keypoints.y.data(), *response = keypoints.response.data();
+    const float robustness = 0.9f;
+    vector<float> &radiusSq = scratch.floats.acquire();
+    radiusSq.assign(numCandidates, numeric_limits<float>::max());
+    for (size_t i = 1; i < numCandidates; ++i)
+    {
+        int k = ranked[i];
+        float rankScore = (float)(numCandidates - i); // used if there is no response information
+        for (size_t j = 0; j < i; ++j)
+        {
+            int s = ranked[j]; // stronger
+            bool bDominated = response[k] != response[s] ? response[k] < robustness * response[s]
+                                                         : rankScore < robustness * (float)(numCandidates - j);
+            if (bDominated)
+            {
+                float dx = x[k] - x[s], dy = y[k] - y[s];
+                radiusSq[i] = min(radiusSq[i], dx * dx + dy * dy);
+            }
+        }
+    }
+
+    vector<int> &order = scratch.ints.acquire();
+    order.resize(numCandidates);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(),
+         [&](int a, int b) { return radiusSq[a] != radiusSq[b] ? radiusSq[a] > radiusSq[b] : a < b; });
+    for (size_t i = 0; i < order.size() && (int)selected.size() < maxKeypoints; ++i)
+    {
+        selected.push_back(ranked[order[i]]);
+    }
+}
+
+// marks (keep[i] = 1) at most budget.maxKeypoints of the candidates (store indices) inside area
+void markSelected(const KeypointStore &keypoints, vector<int> &candidates, const cv::Rect &area,
+                  const KeypointBudget &budget, FrameArena &scratch, vector<uchar> &keep)
+{
+    if ((int)candidates.size() <= budget.maxKeypoints)
+    {
+        for (int idx : candidates)
+        {
+            keep[idx] = 1;
+        }
+        return;
+    }
+
+    rankKeypoints(keypoints, candidates);
+    vector<int> &selected = scratch.ints.acquire();
+    switch (budget.method)
+    {
+    case BUDGET_ANMS:
+        selectAnms(keypoints, candidates, budget.maxKeypoints, scratch, selected);
+        break;
+    case BUDGET_BEST:
+        selected.assign(candidates.begin(), candidates.begin() + budget.maxKeypoints);
+        break;
+    default:
+        selectGrid(keypoints, candidates, area, budget, scratch, selected);
+        break;
+    }
+    for (int idx : selected)
+    {
+        keep[idx] = 1;
+    }
+}
+
+// ORB's pyramid: 8 levels, scale factor 1.2, edgeThreshold 31
+const int orbLevels = 8;
+const double orbScaleFactor = 1.2;
+const int orbBorder = 32;
+} // namespace
+
+BudgetMethod parseBudgetMethod(const string &name)
+{
+    static const char *names[] = {"GRID", "ANMS", "BEST"};
+    for (int i = 0; i < BUDGET_INVALID; ++i)
+    {
+        if (name.compare(names[i]) == 0)
+        {
+            return (BudgetMethod)i;
+        }
+    }
+    return BUDGET_INVALID;
+}
+
+const char *budgetMethodName(BudgetMethod method)
+{
+    static const char *names[] = {"GRID", "ANMS", "BEST", "INVALID"};
+    return names[method];
+}
+
+void selectKeypoints(KeypointStore &keypoints, const cv::Rect &area, const KeypointBudget &budget, FrameArena *scratch)
+{
+    if (budget.maxKeypoints <= 0 || (int)keypoints.count() <= budget.maxKeypoints)
+    {
+        return;
+    }
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    vector<int> &candidates = arena.ints.acquire();
+    candidates.resize(keypoints.count());
+    iota(candidates.begin(), candidates.end(), 0);
+    vector<uchar> &keep = arena.bytes.acquire();
+    keep.assign(keypoints.count(), 0);
+    markSelected(keypoints, candidates, area, budget, arena, keep);
+    keypoints.compact(keep);
+}
+
+void applyKeypointBudget(KeypointStore &keypoints, const vector<cv::Rect> &regions, const KeypointBudget &budget,
+                         FrameArena *scratch)
+{
+    if (budget.maxKeypoints <= 0)
+    {
+        return;
+    }
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    // keypoints outside all regions are kept, the others compete within the first region containing them
+    size_t n = keypoints.count();
+    vector<int> &regionOf = arena.ints.acquire();
+    vector<uchar> &keep = arena.bytes.acquire();
+    regionOf.resize(n);
+    keep.assign(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        cv::Point2f pt(keypoints.x[i], keypoints.y[i]);
+        size_t r = 0;
+        while (r < regions.size() && !regions[r].contains(pt))
+        {
+            ++r;
+        }
+        regionOf[i] = (int)r;
+        keep[i] = r == regions.size();
+    }
+
+    vector<int> &candidates = arena.ints.acquire();
+    for (size_t r = 0; r < regions.size(); ++r)
+    {
+        candidates.clear();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (regionOf[i] == (int)r)
+            {
+                candidates.push_back((int)i);
+            }
+        }
+        markSelected(keypoints, candidates, regions[r], budget, arena, keep);
+    }
+    keypoints.compact(keep);
+}
+
+size_t estimateDescriptorBytes(const KeypointStore &keypoints, DescriptorType descriptorType, cv::Size imgSize)
+{
+    double area = (double)imgSize.width * imgSize.height;
+    double bytes = (double)keypoints.count() * (descriptorBytes(descriptorType) + sizeof(cv::KeyPoint));
+
+    if (descriptorType == DESC_ORB)
+    {   // one bordered 8 bit pyramid level per octave found on the keypoints
+        int maxOctave = 0;
+        for (int octave : keypoints.octave)
+        {
+            maxOctave = max(maxOctave, octave);
+        }
+        double numLevels = max(orbLevels, maxOctave + 1);
+        double scale = 1.0;
+        for (int level = 0; level < min(numLevels, 100.0); ++level, scale /= orbScaleFactor)
+        {
+            bytes += (imgSize.width * scale + 2 * orbBorder) * (imgSize.height * scale + 2 * orbBorder);
+        }
+        // beyond that the levels are nothing but border
+        bytes += max(0.0, numLevels - 100.0) * (2.0 * orbBorder) * (2.0 * orbBorder);
+    }
+    else if (descriptorType == DESC_SIFT)
+    {   // float scale space on the 2x upsampled image: 6 Gaussian + 5 DoG images per octave, octaves add 1/3
+        bytes += 4.0 * area * sizeof(float) * 11 * 4.0 / 3.0;
+    }
+    else if (descriptorType == DESC_AKAZE)
+    {   // nonlinear scale space: 4 sublevels x ~6 float images, octaves add 1/3
+        bytes += area * sizeof(float) * 4 * 6 * 4.0 / 3.0;
+    }
+    else
+    {   // BRISK, BRIEF, FREAK: smoothed image / pyramid plus an integral image
+        bytes += area * (2.0 + sizeof(int));
+    }
+    return (size_t)min(bytes, (double)numeric_limits<size_t>::max());
+}
+
+bool enforceDescriptorMemory(KeypointStore &keypoints, DescriptorType descriptorType, cv::Size imgSize,
+                             const KeypointBudget &budget, FrameArena *scratch)
+{
+    if (estimateDescriptorBytes(keypoints, descriptorType, imgSize) <= budget.maxDescriptorBytes)
+    {
+        return false;
+    }
+
+    if (descriptorType == DESC_ORB)
+    {   // foreign octaves (e.g. SIFT's packed octave/layer/scale): derive the ORB level from the keypoint size
+        for (size_t i = 0; i < keypoints.count(); ++i)
+        {
+            if (keypoints.octave[i] < 0 || keypoints.octave[i] >= orbLevels)
+            {
+                int level = (int)round(log(max(1.0f, keypoints.size[i]) / 31.0) / log(orbScaleFactor));
+                keypoints.octave[i] = min(orbLevels - 1, max(0, level));
+            }
+        }
+    }
+
+    // still too large: drop the weakest keypoints until the descriptor matrix fits
+    size_t fixedBytes = estimateDescriptorBytes(KeypointStore(), descriptorType, imgSize);
+    size_t perKeypoint = descriptorBytes(descriptorType) + sizeof(cv::KeyPoint);
+    if (estimateDescriptorBytes(keypoints, descriptorType, imgSize) > budget.maxDescriptorBytes)
+    {
+        size_t maxKeypoints = budget.maxDescriptorBytes > fixedBytes ? (budget.maxDescriptorBytes - fixedBytes) / perKeypoint : 0;
+        KeypointBudget best = budget;
+        best.method = BUDGET_BEST;
+        best.maxKeypoints = (int)min(maxKeypoints, (size_t)numeric_limits<int>::max());
+        if (best.maxKeypoints == 0)
+        {
+            keypoints.clear();
+        }
+        else
+        {
+            selectKeypoints(keypoints, cv::Rect(0, 0, imgSize.width, imgSize.height), best, scratch);
+        }
+    }
+    return true;
+}
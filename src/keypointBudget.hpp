@@ -0,0 +1,62 @@
+#ifndef keypointBudget_hpp
+#define keypointBudget_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "frameArena.hpp"
+#include "pipelineTypes.hpp"
+
+
+// how the keypoint budget picks the survivors of a region
+enum BudgetMethod
+{
+    BUDGET_GRID, // round robin over grid buckets (spatially uniform)
+    BUDGET_ANMS, // adaptive non-maximal suppression
+    BUDGET_BEST, // strongest responses (what retainBest does)
+    BUDGET_INVALID
+};
+
+// "GRID", "ANMS", "BEST"; BUDGET_INVALID for unknown names
+BudgetMethod parseBudgetMethod(const std::string &name);
+const char *budgetMethodName(BudgetMethod method);
+
+// Keypoint budget applied between detection and description. It caps the keypoints per region with a
+// spatially uniform selection, so describe and match cost per frame stay bounded without all keypoints
+// ending up on the single most textured spot (which is what retainBest does).
+struct KeypointBudget
+{
+    int maxKeypoints = 50;            // per region of interest, 0 = no cap
+    BudgetMethod method = BUDGET_GRID;
+    int gridCols = 8;                 // GRID: no. of buckets across the region
+    int gridRows = 8;                 // GRID: no. of buckets down the region
+    size_t maxDescriptorBytes = 1024 * 1024 * 1024; // memory the descriptor extraction may use per frame
+};
+
+// The functions below work on the SoA working copy of the detections (see KeypointStore) between detection
+// and description; intermediates come from scratch if given (a local arena otherwise). Survivors keep their
+// detector order.
+
+// Keep at most budget.maxKeypoints of the keypoints inside area. Keypoints without response information
+// (all responses equal) are ranked by their order, i.e. the order the detector returned them in.
+void selectKeypoints(KeypointStore &keypoints, const cv::Rect &area, const KeypointBudget &budget,
+                     FrameArena *scratch = nullptr);
+
+// Apply the budget to every region separately; a keypoint belongs to the first region containing it.
+// Keypoints outside all regions are kept unchanged.
+void applyKeypointBudget(KeypointStore &keypoints, const std::vector<cv::Rect> &regions, const KeypointBudget &budget,
+                         FrameArena *scratch = nullptr);
+
+// Rough upper bound of the memory descKeypoints needs for these keypoints: the descriptor matrix plus the
+// scale space / pyramid the extractor builds. ORB builds one pyramid level per keypoint octave, which is what
+// explodes with SIFT keypoints (their octave field packs octave, layer and scale, see NOTE 1 in the main file).
+size_t estimateDescriptorBytes(const KeypointStore &keypoints, DescriptorType descriptorType, cv::Size imgSize);
+
+// Makes sure describing the keypoints stays within budget.maxDescriptorBytes: first by mapping keypoint
+// octaves the extractor cannot interpret onto its own pyramid, then by dropping the weakest keypoints.
+// Returns true if the keypoints had to be changed.
+bool enforceDescriptorMemory(KeypointStore &keypoints, DescriptorType descriptorType, cv::Size imgSize,
+                             const KeypointBudget &budget, FrameArena *scratch = nullptr);
+
+#endif /* keypointBudget_hpp */
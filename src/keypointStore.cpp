@@ -0,0 +1,149 @@
+#include "keypointStore.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KEYPOINT_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+// rounded position inside [x, x + width) x [y, y + height) of any rect, for keypoints [begin, end)
+void markInsideScalar(const float *x, const float *y, size_t begin, size_t end, const vector<cv::Rect> &rects,
+                      uchar *mask)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        int xi = cvRound(x[i]), yi = cvRound(y[i]);
+        uchar inside = 0;
+        for (const cv::Rect &r : rects)
+        {
+            inside |= xi >= r.x && xi < r.x + r.width && yi >= r.y && yi < r.y + r.height;
+        }
+        mask[i] = inside;
+    }
+}
+
+#ifdef KEYPOINT_X86
+// 8 keypoints per iteration: round like cvRound (nearest even), four integer compares per rect, OR over the rects.
+// Returns the no. of keypoints handled, the rest is left to the scalar loop.
+__attribute__((target("avx2"))) size_t markInsideAvx2(const float *x, const float *y, size_t n,
+                                                      const vector<cv::Rect> &rects, uchar *mask)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i xi = _mm256_cvtps_epi32(_mm256_load_ps(x + i));
+        __m256i yi = _mm256_cvtps_epi32(_mm256_load_ps(y + i));
+        __m256i inside = _mm256_setzero_si256();
+        for (const cv::Rect &r : rects)
+        {
+            // x >= r.x  <=>  x > r.x - 1, x < r.x + width  <=>  r.x + width > x
+            __m256i in = _mm256_and_si256(_mm256_cmpgt_epi32(xi, _mm256_set1_epi32(r.x - 1)),
+                                          _mm256_cmpgt_epi32(_mm256_set1_epi32(r.x + r.width), xi));
+            in = _mm256_and_si256(in, _mm256_cmpgt_epi32(yi, _mm256_set1_epi32(r.y - 1)));
+            in = _mm256_and_si256(in, _mm256_cmpgt_epi32(_mm256_set1_epi32(r.y + r.height), yi));
+            inside = _mm256_or_si256(inside, in);
+        }
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(inside));
+        for (int k = 0; k < 8; ++k)
+        {
+            mask[i + k] = (uchar)((bits >> k) & 1);
+        }
+    }
+    return i;
+}
+#endif /* KEYPOINT_X86 */
+} // namespace
+
+void KeypointStore::clear()
+{
+    resize(0);
+}
+
+void KeypointStore::resize(size_t n)
+{
+    x.resize(n);
+    y.resize(n);
+    size.resize(n);
+    angle.resize(n);
+    response.resize(n);
+    octave.resize(n);
+    classId.resize(n);
+    row.resize(n);
+}
+
+void KeypointStore::assign(const vector<cv::KeyPoint> &keypoints)
+{
+    resize(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); ++i)
+    {
+        const cv::KeyPoint &kp = keypoints[i];
+        x[i] = kp.pt.x;
+        y[i] = kp.pt.y;
+        size[i] = kp.size;
+        angle[i] = kp.angle;
+        response[i] = kp.response;
+        octave[i] = kp.octave;
+        classId[i] = kp.class_id;
+        row[i] = (int)i;
+    }
+}
+
+void KeypointStore::toKeyPoints(vector<cv::KeyPoint> &keypoints) const
+{
+    keypoints.resize(count());
+    for (size_t i = 0; i < keypoints.size(); ++i)
+    {
+        keypoints[i] = cv::KeyPoint(x[i], y[i], size[i], angle[i], response[i], octave[i], classId[i]);
+    }
+}
+
+size_t KeypointStore::markInside(const vector<cv::Rect> &rects, vector<uchar> &mask) const
+{
+    size_t n = count();
+    mask.resize(n);
+    size_t done = 0;
+#ifdef KEYPOINT_X86
+    static const bool bAvx2 = __builtin_cpu_supports("avx2");
+    if (bAvx2)
+    {
+        done = markInsideAvx2(x.data(), y.data(), n, rects, mask.data());
+    }
+#endif
+    markInsideScalar(x.data(), y.data(), done, n, rects, mask.data());
+
+    size_t numInside = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        numInside += mask[i];
+    }
+    return numInside;
+}
+
+void KeypointStore::compact(const vector<uchar> &mask)
+{
+    CV_Assert(mask.size() == count());
+    size_t kept = 0;
+    for (size_t i = 0; i < mask.size(); ++i)
+    {
+        if (!mask[i])
+        {
+            continue;
+        }
+        if (kept != i)
+        {
+            x[kept] = x[i];
+            y[kept] = y[i];
+            size[kept] = size[i];
+            angle[kept] = angle[i];
+            response[kept] = response[i];
+            octave[kept] = octave[i];
+            classId[kept] = classId[i];
+            row[kept] = row[i];
+        }
+        ++kept;
+    }
+    resize(kept);
+}
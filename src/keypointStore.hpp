@@ -0,0 +1,67 @@
+#ifndef keypointStore_hpp
+#define keypointStore_hpp
+
+#include <cstddef>
+#include <vector>
+#include <opencv2/core.hpp>
+
+
+// std::allocator replacement handing out cv::fastMalloc memory, i.e. aligned to CV_MALLOC_ALIGN (>= 32 byte),
+// so the SIMD loops of KeypointStore can use aligned loads
+template <typename T>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(cv::fastMalloc(n * sizeof(T))); }
+    void deallocate(T *p, size_t) { cv::fastFree(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return false; }
+
+// Keypoints as a structure of arrays. The stages between detection and description only look at a few
+// fields of every keypoint (the ROI filter at the position, the budget at position and response, the
+// descriptor memory check at octave and size), so they run on separate, SIMD aligned arrays instead of the
+// 28 byte cv::KeyPoint. cv::KeyPoint is only used at the API boundaries: assign() takes over the detector
+// output, toKeyPoints() hands the survivors to the extractor / matcher. The arrays keep their capacity, so a
+// reused store does not allocate.
+class KeypointStore
+{
+public:
+    template <typename T>
+    using Array = std::vector<T, AlignedAllocator<T>>;
+
+    Array<float> x, y;      // KeyPoint::pt
+    Array<float> size;
+    Array<float> angle;     // needed by the oriented descriptors (ORB, BRISK, AKAZE, SIFT)
+    Array<float> response;
+    Array<int> octave;
+    Array<int> classId;     // AKAZE keeps the evolution level here
+    Array<int> row;         // index in the detector output, i.e. the descriptor row of a fused detect + describe
+
+    size_t count() const { return x.size(); }
+    void clear();
+
+    void assign(const std::vector<cv::KeyPoint> &keypoints);
+    void toKeyPoints(std::vector<cv::KeyPoint> &keypoints) const;
+
+    // mask[i] = 1 if keypoint i lies in at least one of the rects, else 0. Same test as cv::Rect::contains
+    // (which rounds the position to int). AVX2 if the CPU has it. Returns the no. of keypoints inside.
+    size_t markInside(const std::vector<cv::Rect> &rects, std::vector<uchar> &mask) const;
+
+    // keeps the keypoints with mask[i] != 0 in their order (row keeps pointing at their detector output index)
+    void compact(const std::vector<uchar> &mask);
+
+private:
+    void resize(size_t n);
+};
+
+#endif /* keypointStore_hpp */
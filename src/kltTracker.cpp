@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <opencv2/video/tracking.hpp>
+
+#include "frameArena.hpp"
+#include "gridMatcher.hpp"
+#include "kltTracker.hpp"
+
+using namespace std;
+
+KltTracker::KltTracker(const KltParams &params) : params(params)
+{
+}
+
+void KltTracker::reset()
+{
+    framesSinceKeyframe = 0;
+    keyframeCount = trackedCount = 0;
+    keyframeCells = trackedCells = 0;
+    bHaveKeyframe = false;
+    frameCount = pyramidFrame = 0;
+}
+
+bool KltTracker::needsKeyframe() const
+{
+    if (!bHaveKeyframe || framesSinceKeyframe + 1 >= params.keyframeInterval)
+    {
+        return true;
+    }
+    if (framesSinceKeyframe == 0)
+    {
+        return false; // nothing tracked yet since the keyframe
+    }
+    size_t minCount = max((size_t)params.minTracked, (size_t)(params.minTrackedRatio * keyframeCount));
+    return trackedCount < minCount || trackedCells < params.minSpread * keyframeCells;
+}
+
+int KltTracker::countOccupiedCells(const vector<cv::KeyPoint> &keypoints, const vector<cv::Rect> &rois)
+{
+    int grid = max(1, params.spreadGrid);
+    cells.assign(rois.size() * grid * grid, 0);
+    for (const cv::KeyPoint &kp : keypoints)
+    {
+        for (size_t r = 0; r < rois.size(); ++r)
+        {   // a keypoint counts for the first region containing it, like the keypoint budget
+            const cv::Rect &roi = rois[r];
+            if (roi.contains(kp.pt))
+            {
+                int c = min(grid - 1, (int)((kp.pt.x - roi.x) * grid / max(1, roi.width)));
+                int w = min(grid - 1, (int)((kp.pt.y - roi.y) * grid / max(1, roi.height)));
+                cells[(r * grid + w) * grid + c] = 1;
+                break;
+            }
+        }
+    }
+    return (int)count(cells.begin(), cells.end(), 1);
+}
+
+void KltTracker::setKeyframe(const DataFrame &currFrame, const vector<cv::Rect> &rois)
+{
+    bHaveKeyframe = true;
+    framesSinceKeyframe = 0;
+    ++frameCount; // detected, so prevPyramid (if any) is of an older frame
+    keyframeCount = trackedCount = currFrame.keypoints.size();
+    keyframeCells = trackedCells = countOccupiedCells(currFrame.keypoints, rois);
+}
+
+void KltTracker::buildPyramid(const cv::Mat &img, vector<cv::Mat> &pyramid) const
+{
+    cv::buildOpticalFlowPyramid(img, pyramid, params.winSize, params.maxLevel);
+}
+
+double KltTracker::track(const DataFrame &prevFrame, DataFrame &currFrame, const vector<cv::Rect> &rois)
+{
+    double t = (double)cv::getTickCount();
+    const vector<cv::KeyPoint> &prevKeypoints = prevFrame.keypoints;
+    vector<cv::KeyPoint> &keypoints = currFrame.keypoints;
+    vector<cv::DMatch> &matches = currFrame.kptMatches;
+    keypoints.clear();
+    matches.clear();
+
+    // one pyramid per frame: the current frame's pyramid is the previous one of the next track() call, unless
+    // a keyframe came in between (keyed on the frame count, a recycled buffer slot may hold new pixels at the
+    // same address)
+    if (pyramidFrame == 0 || pyramidFrame != frameCount)
+    {
+        buildPyramid(prevFrame.cameraImg, prevPyramid);
+    }
+    buildPyramid(currFrame.cameraImg, currPyramid);
+
+    cv::KeyPoint::convert(prevKeypoints, prevPts);
+    if (!prevPts.empty())
+    {
+        cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01);
+        cv::calcOpticalFlowPyrLK(prevPyramid, currPyramid, prevPts, currPts, status, err, params.winSize,
+                                 params.maxLevel, criteria);
+        // backward pass from the forward result, seeded with the start so it converges quickly
+        backPts = prevPts;
+        cv::calcOpticalFlowPyrLK(currPyramid, prevPyramid, currPts, backPts, backStatus, err, params.winSize,
+                                 params.maxLevel, criteria, cv::OPTFLOW_USE_INITIAL_FLOW);
+    }
+
+    const float maxFbError2 = params.maxFbError * params.maxFbError;
+    for (size_t i = 0; i < prevPts.size(); ++i)
+    {
+        if (!status[i] || !backStatus[i])
+        {
+            continue;
+        }
+        cv::Point2f fb = backPts[i] - prevPts[i];
+        float fbError2 = fb.dot(fb);
+        bool bInside = rois.empty();
+        for (size_t r = 0; r < rois.size() && !bInside; ++r)
+        {
+            bInside = rois[r].contains(currPts[i]);
+        }
+        if (fbError2 > maxFbError2 || !bInside)
+        {
+            continue;
+        }
+        cv::KeyPoint kp = prevKeypoints[i];
+        kp.pt = currPts[i];
+        matches.push_back(cv::DMatch((int)i, (int)keypoints.size(), sqrt(fbError2)));
+        keypoints.push_back(kp);
+    }
+
+    // the tracked keypoints keep their keyframe descriptors
+    const cv::Mat &prevDescriptors = prevFrame.descriptors;
+    currFrame.descriptors = cv::Mat();
+    if (!prevDescriptors.empty())
+    {
+        currFrame.descriptors = reuseRows(currFrame.descriptorStorage, (int)keypoints.size(), prevDescriptors.cols,
+                                          prevDescriptors.type());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            prevDescriptors.row(matches[i].queryIdx).copyTo(currFrame.descriptors.row((int)i));
+        }
+    }
+    updateKeypointFlow(prevKeypoints, currFrame);
+
+    swap(prevPyramid, currPyramid);
+    pyramidFrame = ++frameCount;
+    ++framesSinceKeyframe;
+    trackedCount = keypoints.size();
+    trackedCells = countOccupiedCells(keypoints, rois);
+    return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
@@ -0,0 +1,68 @@
+#ifndef kltTracker_hpp
+#define kltTracker_hpp
+
+#include <cstddef>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+
+struct KltParams
+{
+    int keyframeInterval = 5;                // detect + describe at least every N frames
+    cv::Size winSize = cv::Size(21, 21);     // Lucas-Kanade search window per pyramid level
+    int maxLevel = 3;                        // pyramid levels above the full resolution image
+    float maxFbError = 1.0f;                 // px, max. distance between a keypoint and its forward-backward track
+    float minTrackedRatio = 0.5f;            // new keyframe below this fraction of the keyframe's keypoints
+    int minTracked = 20;                     // ... or below this no. of keypoints
+    float minSpread = 0.5f;                  // ... or when fewer than this fraction of the keyframe's ROI cells stay occupied
+    int spreadGrid = 4;                      // spread = occupied cells of a spreadGrid x spreadGrid grid over every ROI
+};
+
+// Detect-every-N tracking: between keyframes the keypoints of the previous frame are followed with pyramidal
+// Lucas-Kanade optical flow instead of being detected, described and matched again. A track is kept if the
+// backward flow returns to within maxFbError of the start and it is still inside the regions of interest.
+// Tracked keypoints carry the descriptor rows of their keyframe along, so the next keyframe is matched by
+// descriptor as usual. The tracker reports when a new keyframe is due (interval, count or spread).
+// One tracker per sequence; it keeps the image pyramid of the last tracked frame and its point buffers.
+class KltTracker
+{
+public:
+    explicit KltTracker(const KltParams &params = KltParams());
+
+    // true if the next frame should be detected + described instead of tracked
+    bool needsKeyframe() const;
+
+    // currFrame was detected + described: it becomes the reference for the spread / count thresholds
+    void setKeyframe(const DataFrame &currFrame, const std::vector<cv::Rect> &rois);
+
+    // Tracks prevFrame's keypoints into currFrame: sets currFrame.keypoints, descriptors, kptMatches (queryIdx
+    // into prevFrame.keypoints, distance = forward-backward error) and kptFlow. Returns the time in seconds.
+    // prevFrame must be the frame last passed to track() or setKeyframe() (since reset()).
+    double track(const DataFrame &prevFrame, DataFrame &currFrame, const std::vector<cv::Rect> &rois);
+
+    void reset();
+
+private:
+    int countOccupiedCells(const std::vector<cv::KeyPoint> &keypoints, const std::vector<cv::Rect> &rois);
+    void buildPyramid(const cv::Mat &img, std::vector<cv::Mat> &pyramid) const;
+
+    KltParams params;
+    int framesSinceKeyframe = 0;
+    size_t keyframeCount = 0;
+    int keyframeCells = 0;
+    size_t trackedCount = 0;
+    int trackedCells = 0;
+    bool bHaveKeyframe = false;
+
+    std::vector<cv::Mat> prevPyramid, currPyramid;
+    size_t frameCount = 0;   // frames passed to track() or setKeyframe() since reset()
+    size_t pyramidFrame = 0; // frameCount of the frame prevPyramid was built from, 0 = none
+    std::vector<cv::Point2f> prevPts, currPts, backPts;
+    std::vector<uchar> status, backStatus;
+    std::vector<float> err;
+    std::vector<uchar> cells;
+};
+
+#endif /* kltTracker_hpp */
@@ -19,11 +19,100 @@
 #include "dataStructures.h"
 
 
+// multi-probe LSH index used by MAT_FLANN for binary descriptors: more tables / probes raise recall,
+// longer keys make buckets smaller and queries faster
+struct LshParams
+{
+    int tableNumber = 12;    // no. of hash tables
+    int keySize = 20;        // no. of bits per hash key
+    int multiProbeLevel = 2; // no. of neighbouring buckets probed (0 = standard LSH)
+};
+
+
 double detKeypointsHarris(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool bVis=false);
 double detKeypointsShiTomasi(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool bVis=false);
+cv::Ptr<cv::FeatureDetector> createFeatureDetector(std::string detectorType);
 double detKeypointsModern(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType, bool bVis=false);
+double detKeypoints(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType, bool bVis=false);
+int detectorRoiPadding(std::string detectorType);
+double detKeypointsRoi(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType,
+                       const std::vector<cv::Rect> &rois, bool bVis=false);
+cv::Ptr<cv::DescriptorExtractor> createDescriptorExtractor(std::string descriptorType);
 double descKeypoints(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, std::string descriptorType);
-void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::KeyPoint> &kPtsRef, cv::Mat &descSource, cv::Mat &descRef,
-                      std::vector<cv::DMatch> &matches, std::string descriptorCategory, std::string matcherType, std::string selectorType);
+bool isFusedPair(std::string detectorType, std::string descriptorType);
+double detectAndDescribe(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, std::string featureType);
+double detectAndDescribeRoi(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, std::string featureType,
+                            const std::vector<cv::Rect> &rois);
+void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::KeyPoint> &kPtsRef, const cv::Mat &descSource, const cv::Mat &descRef,
+                      std::vector<cv::DMatch> &matches, std::string descriptorCategory, std::string matcherType, std::string selectorType,
+                      const LshParams &lshParams = LshParams(), FrameArena *scratch = nullptr, bool bVerbose = true);
+bool usesHammingKernel(const cv::Mat &descSource, const cv::Mat &descRef, std::string descriptorCategory,
+                       std::string matcherType, std::string selectorType);
+bool usesQuantizedKernel(const cv::Mat &descSource, const cv::Mat &descRef, std::string descriptorCategory,
+                         std::string matcherType, std::string selectorType);
+cv::Ptr<cv::DescriptorMatcher> trainMatcher(const cv::Mat &descRef, std::string descriptorCategory, std::string matcherType,
+                                            const LshParams &lshParams = LshParams());
+void matchDescriptors(const cv::Ptr<cv::DescriptorMatcher> &refMatcher, const cv::Mat &descSource,
+                      std::vector<cv::DMatch> &matches, std::string selectorType, FrameArena *scratch = nullptr,
+                      bool bVerbose = true); // bVerbose: print how many matches the ratio test removed
+double matchRecall(const std::vector<cv::DMatch> &approxMatches, const std::vector<cv::DMatch> &exactMatches);
+
+// Shared by the ROI detection functions: runs detect(subImg, roiKeypoints, roiDescriptors) on every
+// padded ROI and collects the keypoints inside the (unpadded) ROI in frame coordinates, together with their
+// descriptor rows if descriptors is given. With a scratch arena the per-ROI results reuse its buffers.
+template <typename DetectFn>
+double detectInRois(std::vector<cv::KeyPoint> &keypoints, cv::Mat *descriptors, const cv::Mat &img, int padding,
+                    const std::vector<cv::Rect> &rois, DetectFn detect, FrameArena *scratch = nullptr)
+{
+    std::vector<cv::KeyPoint> localKeypoints;
+    cv::Mat localDescriptors;
+    std::vector<cv::KeyPoint> &roiKeypoints = scratch ? scratch->keypoints.acquire() : localKeypoints;
+    cv::Mat &roiDescriptors = scratch ? scratch->rowBuffer() : localDescriptors;
+
+    double t = 0;
+    cv::Rect imgRect(0, 0, img.cols, img.rows);
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        cv::Rect roi = rois[i] & imgRect;
+        if (roi.empty())
+        {
+            continue;
+        }
+        cv::Rect paddedRoi = cv::Rect(roi.x - padding, roi.y - padding, roi.width + 2 * padding, roi.height + 2 * padding) & imgRect;
+
+        cv::Mat subImg = img(paddedRoi);
+        roiKeypoints.clear();
+        t += detect(subImg, roiKeypoints, roiDescriptors);
+
+        cv::Point2f offset((float)paddedRoi.x, (float)paddedRoi.y);
+        for (size_t k = 0; k < roiKeypoints.size(); ++k)
+        {
+            cv::KeyPoint kp = roiKeypoints[k];
+            kp.pt += offset;
+            if (!roi.contains(kp.pt))
+            {
+                continue;
+            }
+            bool bSeen = false;
+            for (size_t j = 0; j < i && !bSeen; ++j)
+            {
+                bSeen = rois[j].contains(kp.pt);
+            }
+            if (!bSeen)
+            {
+                keypoints.push_back(kp);
+                if (descriptors)
+                {   // a reused row buffer may still have the shape of another descriptor
+                    if (descriptors->data && (descriptors->cols != roiDescriptors.cols || descriptors->type() != roiDescriptors.type()))
+                    {
+                        descriptors->release();
+                    }
+                    descriptors->push_back(roiDescriptors.row((int)k));
+                }
+            }
+        }
+    }
+    return t;
+}
 
 #endif /* matching2D_hpp */
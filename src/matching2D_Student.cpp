@@ -1,118 +1,200 @@
+#include <set>
 #include <numeric>
 #include "matching2D.hpp"
+#include "hammingMatcher.hpp"
+#include "quantizedMatcher.hpp"
+#include "cornerDetector.hpp"
+#include "pipelineTypes.hpp"
+#include "typedFeatures.hpp"
 
 #include <typeinfo>
 
 using namespace std;
 
-// Find best matches for keypoints in two camera images based on several matching methods
-void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::KeyPoint> &kPtsRef, cv::Mat &descSource, cv::Mat &descRef,
-                      std::vector<cv::DMatch> &matches, std::string descriptorCategory, std::string matcherType, std::string selectorType)
+// True if the SIMD Hamming matcher (no index, brute force) handles this configuration
+bool usesHammingKernel(const cv::Mat &descSource, const cv::Mat &descRef, std::string descriptorCategory,
+                       std::string matcherType, std::string selectorType)
+{
+    return matcherType.compare("MAT_BF") == 0 && selectorType.compare("SEL_KNN") == 0 &&
+           descriptorCategory.compare("DES_BINARY") == 0 &&
+           isHammingMatchable(descSource) && descSource.cols == descRef.cols && descSource.type() == descRef.type();
+}
+
+// True if the integer L2 matcher handles this configuration: float descriptors which were quantized to uint8
+bool usesQuantizedKernel(const cv::Mat &descSource, const cv::Mat &descRef, std::string descriptorCategory,
+                         std::string matcherType, std::string selectorType)
+{
+    return matcherType.compare("MAT_BF") == 0 && selectorType.compare("SEL_KNN") == 0 &&
+           descriptorCategory.compare("DES_HOG") == 0 &&
+           isQuantizedMatchable(descSource) && descSource.cols == descRef.cols && descSource.type() == descRef.type();
+}
+
+// Create a matcher and train it (i.e. build its index) on the reference descriptors. The result can be kept
+// and queried with any number of source descriptor sets, see the matchDescriptors overload below.
+cv::Ptr<cv::DescriptorMatcher> trainMatcher(const cv::Mat &descRef, std::string descriptorCategory, std::string matcherType,
+                                            const LshParams &lshParams)
 {
     // configure matcher
     bool crossCheck = false;
+    cv::Mat trainRef = descRef; // header only, replaced if a conversion is needed
     cv::Ptr<cv::DescriptorMatcher> matcher;
 
-    if (matcherType.compare("MAT_BF") == 0)
+    switch (parseMatcherType(matcherType))
     {
-        int normType;
-
-        // for SIFT
-        if (descriptorCategory.compare("DES_HOG") == 0)
-        {
-            normType = cv::NORM_L2;
-        }
-        // for any other binary descriptors
-        else if (descriptorCategory.compare("DES_BINARY") == 0)
-        {
-            normType = cv::NORM_HAMMING;
+    case MATCHER_BF:
+    {   // L2 for SIFT (DES_HOG), Hamming for the binary descriptors
+        int normType = descriptorCategory.compare("DES_HOG") == 0 ? cv::NORM_L2 : cv::NORM_HAMMING;
+        matcher = cv::BFMatcher::create(normType, crossCheck);
+        break;
+    }
+    case MATCHER_FLANN:
+        if (descriptorCategory.compare("DES_BINARY") == 0 && descRef.depth() == CV_8U)
+        {   // binary descriptors: multi-probe LSH directly on the raw bits, no conversion needed
+            matcher = cv::makePtr<cv::FlannBasedMatcher>(
+                cv::makePtr<cv::flann::LshIndexParams>(lshParams.tableNumber, lshParams.keySize, lshParams.multiProbeLevel));
         }
-        else 
-        {
-            std::cout << "matcherType NOT SUPPORTED" << std::endl;
+        else
+        {   // float descriptors: randomized KD-trees. Anything else is converted into a local copy,
+            // the caller's descriptor matrix is never modified
+            if (trainRef.type() != CV_32F)
+            {
+                descRef.convertTo(trainRef, CV_32F);
+            }
+            matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
         }
-
-        matcher = cv::BFMatcher::create(normType, crossCheck);
+        break;
+    default:
+        std::cout << "descriptorMatcher NOT SUPPORTED" << std::endl;
+        return matcher;
     }
 
-    else if (matcherType.compare("MAT_FLANN") == 0)
+    matcher->add(std::vector<cv::Mat>(1, trainRef));
+    matcher->train();
+    return matcher;
+}
+
+// Match source descriptors against a matcher which has already been trained on the reference descriptors.
+// With a scratch arena the kNN candidate list keeps its capacity between frames (knnMatch still rebuilds the
+// per-query vectors inside it, that is up to OpenCV).
+void matchDescriptors(const cv::Ptr<cv::DescriptorMatcher> &refMatcher, const cv::Mat &descSource,
+                      std::vector<cv::DMatch> &matches, std::string selectorType, FrameArena *scratch, bool bVerbose)
+{
+    if (!refMatcher || refMatcher->getTrainDescriptors().empty())
     {
-        // Has its own method of matching. Doesn't depend on DES_HOG/DES_BINARY
-        if (descSource.type() != CV_32F || descRef.type() != CV_32F)
-        {   // OpenCV bug workaround : convert binary descriptors to floating point due to a bug in current OpenCV implementation
-            descSource.convertTo(descSource, CV_32F);
-            descRef.convertTo(descRef, CV_32F);
-        }
-        matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+        return;
     }
-    else 
+
+    // KD-tree matchers were trained on float copies, so the queries need the same type
+    cv::Mat querySource = descSource; // header only, replaced if a conversion is needed
+    int trainType = refMatcher->getTrainDescriptors()[0].type();
+    if (querySource.type() != trainType)
     {
-        std::cout << "descriptorMatcher NOT SUPPORTED" << std::endl;
+        descSource.convertTo(querySource, trainType);
     }
 
-
     // perform matching task
-    if (selectorType.compare("SEL_NN") == 0)
+    switch (parseSelectorType(selectorType))
+    {
+    case SELECTOR_NN:
     {   // nearest neighbor (best match)
-        matcher->match(descSource, descRef, matches); // Finds the best match for each descriptor in desc1
+        refMatcher->match(querySource, matches); // Finds the best match for each descriptor in desc1
+        break;
     }
-    else if (selectorType.compare("SEL_KNN") == 0)
+    case SELECTOR_KNN:
     { // k nearest neighbors (k=2)
 
-        vector<vector<cv::DMatch>> knn_matches;
-        matcher->knnMatch(descSource, descRef, knn_matches, 2); // finds the 2 best matches
+        vector<vector<cv::DMatch>> localKnnMatches;
+        vector<vector<cv::DMatch>> &knn_matches = scratch ? scratch->knnMatches.acquire() : localKnnMatches;
+        refMatcher->knnMatch(querySource, knn_matches, 2); // finds the 2 best matches
         
         double minDescDistRatio = 0.8;
         for (auto it = knn_matches.begin(); it != knn_matches.end(); ++it)
         {
-
-            if ((*it)[0].distance < minDescDistRatio * (*it)[1].distance)
+            // LSH may find fewer than two candidates for a query, which cannot pass the ratio test
+            if (it->size() == 2 && (*it)[0].distance < minDescDistRatio * (*it)[1].distance)
             {
                 matches.push_back((*it)[0]);
             }
         }
-        cout << "# keypoints removed by distRatio = " << knn_matches.size() - matches.size() << endl;
+        if (bVerbose)
+        {
+            cout << "# keypoints removed by distRatio = " << knn_matches.size() - matches.size() << endl;
+        }
+        break;
+    }
+    default:
+        break;
     }
 }
 
-// Use one of several types of state-of-art descriptors to uniquely identify keypoints
-double descKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, string descriptorType)
+// Find best matches for keypoints in two camera images based on several matching methods
+void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::KeyPoint> &kPtsRef, const cv::Mat &descSource, const cv::Mat &descRef,
+                      std::vector<cv::DMatch> &matches, std::string descriptorCategory, std::string matcherType, std::string selectorType,
+                      const LshParams &lshParams, FrameArena *scratch, bool bVerbose)
 {
-    // select appropriate descriptor
-    cv::Ptr<cv::DescriptorExtractor> descriptor;
-    if (descriptorType.compare("BRISK") == 0)
-    {
-
-        int threshold = 30;        // FAST/AGAST detection threshold score.
-        int octaves = 3;           // detection octaves (use 0 to do single scale)
-        float patternScale = 1.0f; // apply this scale to the pattern used for sampling the neighbourhood of a keypoint.
-
-        descriptor = cv::BRISK::create(threshold, octaves, patternScale);
-    }
-    else if (descriptorType.compare("BRIEF") == 0)
-    {
-        descriptor = cv::xfeatures2d::BriefDescriptorExtractor::create();
-    }
-    else if (descriptorType.compare("ORB") == 0)
-    {
-        descriptor = cv::ORB::create();
-    }
-    else if (descriptorType.compare("FREAK") == 0)
+    // binary descriptors + brute force + kNN: SIMD Hamming matcher with the distance ratio test fused in
+    if (usesHammingKernel(descSource, descRef, descriptorCategory, matcherType, selectorType))
     {
-        descriptor = cv::xfeatures2d::FREAK::create();
+        double minDescDistRatio = 0.8;
+        matchHammingKnnRatio(descSource, descRef, matches, (float)minDescDistRatio, scratch);
+        return;
     }
-    else if (descriptorType.compare("AKAZE") == 0)
+
+    // quantized float descriptors + brute force + kNN: integer SIMD L2 on the uint8 rows, ratio test fused in
+    if (usesQuantizedKernel(descSource, descRef, descriptorCategory, matcherType, selectorType))
     {
-        descriptor = cv::AKAZE::create();        
+        double minDescDistRatio = 0.8;
+        matchQuantizedKnnRatio(descSource, descRef, matches, (float)minDescDistRatio, scratch);
+        return;
     }
-    else if (descriptorType.compare("SIFT") == 0)
+
+    // one-off matcher for this pair of frames
+    cv::Ptr<cv::DescriptorMatcher> matcher = trainMatcher(descRef, descriptorCategory, matcherType, lshParams);
+    matchDescriptors(matcher, descSource, matches, selectorType, scratch, bVerbose);
+}
+
+// Create one of several types of state-of-art descriptors to uniquely identify keypoints
+cv::Ptr<cv::DescriptorExtractor> createDescriptorExtractor(string descriptorType)
+{
+    // select appropriate descriptor
+    // (the parameters are those of the descriptor policies, see Feature2DExtractor in typedFeatures.hpp)
+    cv::Ptr<cv::DescriptorExtractor> descriptor;
+    switch (parseDescriptorType(descriptorType))
     {
-        descriptor = cv::xfeatures2d::SIFT::create();
+    case DESC_BRISK:
+        descriptor = Feature2DExtractor<DESC_BRISK>::create();
+        break;
+    case DESC_BRIEF:
+        descriptor = Feature2DExtractor<DESC_BRIEF>::create();
+        break;
+    case DESC_ORB:
+        descriptor = Feature2DExtractor<DESC_ORB>::create();
+        break;
+    case DESC_FREAK:
+        descriptor = Feature2DExtractor<DESC_FREAK>::create();
+        break;
+    case DESC_AKAZE:
+        descriptor = Feature2DExtractor<DESC_AKAZE>::create();
+        break;
+    case DESC_SIFT:
+        descriptor = Feature2DExtractor<DESC_SIFT>::create();
+        break;
+    default:
+       std::cout << "descriptorType NOT SUPPORTED" << std::endl;
+       break;
     }
-    else
+    return descriptor;
+}
+
+// Use one of several types of state-of-art descriptors to uniquely identify keypoints
+double descKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, string descriptorType)
+{
+    cv::Ptr<cv::DescriptorExtractor> descriptor = createDescriptorExtractor(descriptorType);
+    if (!descriptor)
     {
-       std::cout << "descriptorType NOT SUPPORTED" << std::endl;
+        return 0;
     }
+
     // perform feature description
     double t = (double)cv::getTickCount();
     descriptor->compute(img, keypoints, descriptors);
@@ -128,25 +210,21 @@ double detKeypointsShiTomasi(vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool
     int blockSize = 4;       //  size of an average block for computing a derivative covariation matrix over each pixel neighborhood
     double maxOverlap = 0.0; // max. permissible overlap between two features in %
     double minDistance = (1.0 - maxOverlap) * blockSize;
-    int maxCorners = img.rows * img.cols / max(1.0, minDistance); // max. num. of keypoints
 
     double qualityLevel = 0.01; // minimal accepted quality of image corners
     double k = 0.04;
 
-    // Apply corner detection
+    // Apply corner detection: tiled and multi-threaded instead of cv::goodFeaturesToTrack, whose
+    // maxCorners = rows * cols / minDistance forced a global sort of every candidate. Unlike before the
+    // keypoints carry their corner response, sorted strongest first.
+    CornerParams params;
+    params.bHarris = false;
+    params.blockSize = blockSize;
+    params.k = k;
+    params.qualityLevel = qualityLevel;
+    params.minDistance = minDistance;
     double t = (double)cv::getTickCount();
-    vector<cv::Point2f> corners;
-    cv::goodFeaturesToTrack(img, corners, maxCorners, qualityLevel, minDistance, cv::Mat(), blockSize, false, k);
-
-    // add corners to result vector
-    for (auto it = corners.begin(); it != corners.end(); ++it)
-    {
-
-        cv::KeyPoint newKeyPoint;
-        newKeyPoint.pt = cv::Point2f((*it).x, (*it).y);
-        newKeyPoint.size = blockSize;
-        keypoints.push_back(newKeyPoint);
-    }
+    detectCorners(keypoints, img, params);
     t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
     // cout << "Shi-Tomasi detection with n=" << keypoints.size() << " keypoints in " << 1000 * t / 1.0 << " ms" << endl;
 
@@ -165,32 +243,25 @@ double detKeypointsShiTomasi(vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool
 
 double detKeypointsHarris(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool bVis)
 {
-    // Same as Shi-Tomasi but with Harris flag set to true in cv::goodFeaturesToTrack()
-    // OR can use cv::HarrisCorner() method directly
+    // Same as Shi-Tomasi but with the Harris response
 
     // compute detector parameters based on image size
     int blockSize = 4;       //  size of an average block for computing a derivative covariation matrix over each pixel neighborhood
     double maxOverlap = 0.0; // max. permissible overlap between two features in %
     double minDistance = (1.0 - maxOverlap) * blockSize;
-    int maxCorners = img.rows * img.cols / max(1.0, minDistance); // max. num. of keypoints
 
     double qualityLevel = 0.01; // minimal accepted quality of image corners
     double k = 0.04;
 
-    // Apply corner detection
+    // Apply corner detection (see detKeypointsShiTomasi)
+    CornerParams params;
+    params.bHarris = true;
+    params.blockSize = blockSize;
+    params.k = k;
+    params.qualityLevel = qualityLevel;
+    params.minDistance = minDistance;
     double t = (double)cv::getTickCount();
-    vector<cv::Point2f> corners;
-    cv::goodFeaturesToTrack(img, corners, maxCorners, qualityLevel, minDistance, cv::Mat(), blockSize, true, k);
-
-    // add corners to result vector
-    for (auto it = corners.begin(); it != corners.end(); ++it)
-    {
-
-        cv::KeyPoint newKeyPoint;
-        newKeyPoint.pt = cv::Point2f((*it).x, (*it).y);
-        newKeyPoint.size = blockSize;
-        keypoints.push_back(newKeyPoint);
-    }
+    detectCorners(keypoints, img, params);
     t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
     // cout << "Harris detection with n=" << keypoints.size() << " keypoints in " << 1000 * t / 1.0 << " ms" << endl;
 
@@ -207,59 +278,175 @@ double detKeypointsHarris(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, bo
     return t;
 }
 
-double detKeypointsModern(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType, bool bVis)
+// Create one of the modern (FAST, BRISK, ORB, AKAZE, SIFT) detectors
+cv::Ptr<cv::FeatureDetector> createFeatureDetector(std::string detectorType)
 {
-    double t;
     //Output variable type found from the doxygen doc for most algos. 
     // eg1. https://docs.opencv.org/3.4/d5/d51/group__features2d__main.html
     // eg2. https://docs.opencv.org/3.4/df/d74/classcv_1_1FastFeatureDetector.html
     // For Sift, doxygen is old I guess? Used the return type mentioned in this example: https://github.com/oreillymedia/Learning-OpenCV-3_examples/blob/master/example_16-02.cpp
     // Or can use auto. Works functionally, but not easily readable.
-    if (detectorType.compare("FAST") == 0)
-    {
-        cv::Ptr<cv::FastFeatureDetector> fast = cv::FastFeatureDetector::create();
-        t = (double)cv::getTickCount();
-        fast->detect(img, keypoints);
-        t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
-    }
-    else if (detectorType.compare("BRISK") == 0) 
+    cv::Ptr<cv::FeatureDetector> detector;
+    switch (parseDetectorType(detectorType))
     {
-        cv::Ptr<cv::BRISK> brisk = cv::BRISK::create();
-        t = (double)cv::getTickCount();
-        brisk->detect(img, keypoints);
-        t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    case DET_FAST:
+        detector = Feature2DDetector<DET_FAST>::create();
+        break;
+    case DET_BRISK:
+        detector = Feature2DDetector<DET_BRISK>::create();
+        break;
+    case DET_ORB:
+        detector = Feature2DDetector<DET_ORB>::create();
+        break;
+    case DET_AKAZE:
+        detector = Feature2DDetector<DET_AKAZE>::create();
+        break;
+    case DET_SIFT:
+        detector = Feature2DDetector<DET_SIFT>::create();
+        break;
+    default:
+        break;
     }
-    else if (detectorType.compare("ORB") == 0) 
+    return detector;
+}
+
+double detKeypointsModern(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType, bool bVis)
+{
+    double t = 0;
+    cv::Ptr<cv::FeatureDetector> detector = createFeatureDetector(detectorType);
+    if (detector)
     {
-        cv::Ptr<cv::ORB> orb = cv::ORB::create();
         t = (double)cv::getTickCount();
-        orb->detect(img, keypoints);
+        detector->detect(img, keypoints);
         t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
     }
-    else if (detectorType.compare("AKAZE") == 0) 
+
+    // visualize results
+    if (bVis)
     {
-        cv::Ptr<cv::AKAZE> akaze = cv::AKAZE::create();
-        t = (double)cv::getTickCount();
-        akaze->detect(img, keypoints);
-        t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+        cv::Mat visImage = img.clone();
+        cv::drawKeypoints(img, keypoints, visImage, cv::Scalar::all(-1), cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+        string windowName = detectorType + " Detection Results";
+        cv::namedWindow(windowName, 6);
+        cv::imshow(windowName, visImage);
+        cv::waitKey(0);
     }
-    else if (detectorType.compare("SIFT") == 0) 
+    return t;
+}
+
+// Dispatch to the traditional (Shi-Tomasi, Harris) or modern (FAST, BRISK, ORB, AKAZE, SIFT) detectors
+double detKeypoints(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType, bool bVis)
+{
+    double t = 0;
+    switch (parseDetectorType(detectorType))
     {
-        cv::Ptr<cv::Feature2D> sift = cv::xfeatures2d::SIFT::create();
-        t = (double)cv::getTickCount();
-        sift->detect(img, keypoints);
-        t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    case DET_SHITOMASI:
+        t = detKeypointsShiTomasi(keypoints, img, bVis);
+        break;
+    case DET_HARRIS:
+        t = detKeypointsHarris(keypoints, img, bVis);
+        break;
+    case DET_FAST:
+    case DET_BRISK:
+    case DET_ORB:
+    case DET_AKAZE:
+    case DET_SIFT:
+        t = detKeypointsModern(keypoints, img, detectorType, bVis);
+        break;
+    default:
+        std::cout << "detectorType NOT SUPPORTED" << std::endl;
+        break;
     }
+    return t;
+}
+
+// ROI padding of a detector given by name, see detectorRoiPadding(DetectorType) in pipelineTypes.hpp
+int detectorRoiPadding(std::string detectorType)
+{
+    return detectorRoiPadding(parseDetectorType(detectorType));
+}
+
+// Detect keypoints only inside the given regions of interest instead of the full frame. Each ROI is padded by
+// detectorRoiPadding(), the detector runs on that sub-image (a view into img, no copy) and the keypoints are
+// shifted back into frame coordinates. Only keypoints inside the (unpadded) ROI are kept; where ROIs overlap,
+// a keypoint is reported once, for the first ROI that contains it.
+// Note: detectors that normalise over the whole image (Shi-Tomasi/Harris quality level, ORB's nfeatures budget,
+// AKAZE's contrast factor, SIFT's octave count) see the padded ROI only, so counts can differ slightly from
+// full-frame detection followed by filtering.
+double detKeypointsRoi(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, std::string detectorType,
+                       const std::vector<cv::Rect> &rois, bool bVis)
+{
+    double t = detectInRois(keypoints, nullptr, img, detectorRoiPadding(detectorType), rois,
+                            [&](cv::Mat &subImg, vector<cv::KeyPoint> &roiKeypoints, cv::Mat &) {
+                                return detKeypoints(roiKeypoints, subImg, detectorType, false);
+                            });
 
     // visualize results
     if (bVis)
     {
         cv::Mat visImage = img.clone();
         cv::drawKeypoints(img, keypoints, visImage, cv::Scalar::all(-1), cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
-        string windowName = detectorType + " Detection Results";
+        string windowName = detectorType + " ROI Detection Results";
         cv::namedWindow(windowName, 6);
         cv::imshow(windowName, visImage);
         cv::waitKey(0);
     }
     return t;
 }
+
+// True if detector and descriptor are the same scale-space family, i.e. one Feature2D can do both in one pass
+bool isFusedPair(std::string detectorType, std::string descriptorType)
+{
+    return isFusedTypePair(parseDetectorType(detectorType), parseDescriptorType(descriptorType));
+}
+
+// Fused detection and description for the pairs accepted by isFusedPair: detectAndCompute builds the image
+// pyramid / nonlinear scale space once and describes every keypoint at the octave (and for AKAZE the
+// evolution level in class_id) it was detected at, instead of detKeypointsModern and descKeypoints each
+// building it from scratch. Same parameters as those two.
+double detectAndDescribe(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, std::string featureType)
+{
+    if (!isFusedPair(featureType, featureType))
+    {
+        std::cout << "featureType NOT SUPPORTED for fused detection and description" << std::endl;
+        return 0;
+    }
+    cv::Ptr<cv::Feature2D> feature = createFeatureDetector(featureType);
+
+    double t = (double)cv::getTickCount();
+    feature->detectAndCompute(img, cv::noArray(), keypoints, descriptors);
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    return t;
+}
+
+// detectAndDescribe on the padded regions of interest, see detKeypointsRoi
+double detectAndDescribeRoi(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img, cv::Mat &descriptors, std::string featureType,
+                            const std::vector<cv::Rect> &rois)
+{
+    return detectInRois(keypoints, &descriptors, img, detectorRoiPadding(featureType), rois,
+                        [&](cv::Mat &subImg, vector<cv::KeyPoint> &roiKeypoints, cv::Mat &roiDescriptors) {
+                            return detectAndDescribe(roiKeypoints, subImg, roiDescriptors, featureType);
+                        });
+}
+
+// Fraction of the reference matches (e.g. from exact brute force matching) which an approximate matcher found too,
+// i.e. same query keypoint matched to the same train keypoint. Returns 1 if there are no reference matches.
+// Both sets need the same orientation; a query keypoint may appear in several matches.
+double matchRecall(const std::vector<cv::DMatch> &approxMatches, const std::vector<cv::DMatch> &exactMatches)
+{
+    if (exactMatches.empty())
+    {
+        return 1.0;
+    }
+    std::set<std::pair<int, int>> approxPairs; // (queryIdx, trainIdx)
+    for (const cv::DMatch &match : approxMatches)
+    {
+        approxPairs.insert(std::make_pair(match.queryIdx, match.trainIdx));
+    }
+    size_t numFound = 0;
+    for (const cv::DMatch &match : exactMatches)
+    {
+        numFound += approxPairs.count(std::make_pair(match.queryIdx, match.trainIdx));
+    }
+    return (double)numFound / exactMatches.size();
+}
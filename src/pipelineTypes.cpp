@@ -0,0 +1,64 @@
+#include "pipelineTypes.hpp"
+
+using namespace std;
+
+namespace
+{
+const char *detectorNames[] = {"SHITOMASI", "HARRIS", "FAST", "BRISK", "ORB", "AKAZE", "SIFT"};
+const char *descriptorNames[] = {"BRISK", "BRIEF", "ORB", "FREAK", "AKAZE", "SIFT"};
+const char *matcherNames[] = {"MAT_BF", "MAT_FLANN"};
+const char *selectorNames[] = {"SEL_NN", "SEL_KNN"};
+
+// index of name in names, numNames if it is none of them
+int parseName(const string &name, const char *const *names, int numNames)
+{
+    for (int i = 0; i < numNames; ++i)
+    {
+        if (name.compare(names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return numNames;
+}
+} // namespace
+
+DetectorType parseDetectorType(const string &name)
+{
+    return (DetectorType)parseName(name, detectorNames, DET_INVALID);
+}
+
+DescriptorType parseDescriptorType(const string &name)
+{
+    return (DescriptorType)parseName(name, descriptorNames, DESC_INVALID);
+}
+
+MatcherType parseMatcherType(const string &name)
+{
+    return (MatcherType)parseName(name, matcherNames, MATCHER_INVALID);
+}
+
+SelectorType parseSelectorType(const string &name)
+{
+    return (SelectorType)parseName(name, selectorNames, SELECTOR_INVALID);
+}
+
+const char *detectorTypeName(DetectorType type)
+{
+    return type < DET_INVALID ? detectorNames[type] : "INVALID";
+}
+
+const char *descriptorTypeName(DescriptorType type)
+{
+    return type < DESC_INVALID ? descriptorNames[type] : "INVALID";
+}
+
+const char *matcherTypeName(MatcherType type)
+{
+    return type < MATCHER_INVALID ? matcherNames[type] : "INVALID";
+}
+
+const char *selectorTypeName(SelectorType type)
+{
+    return type < SELECTOR_INVALID ? selectorNames[type] : "INVALID";
+}
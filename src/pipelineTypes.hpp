@@ -0,0 +1,111 @@
+#ifndef pipelineTypes_hpp
+#define pipelineTypes_hpp
+
+#include <string>
+#include <opencv2/core.hpp>
+
+
+// Typed counterparts of the detector / descriptor / matcher / selector strings of TrackingConfig. TypedPipeline
+// fixes them at compile time; the traits below are constexpr, so the norm, the descriptor size and whether a
+// pairing works are known statically.
+enum DetectorType
+{
+    DET_SHITOMASI,
+    DET_HARRIS,
+    DET_FAST,
+    DET_BRISK,
+    DET_ORB,
+    DET_AKAZE,
+    DET_SIFT,
+    DET_INVALID
+};
+
+enum DescriptorType
+{
+    DESC_BRISK,
+    DESC_BRIEF,
+    DESC_ORB,
+    DESC_FREAK,
+    DESC_AKAZE,
+    DESC_SIFT,
+    DESC_INVALID
+};
+
+enum MatcherType
+{
+    MATCHER_BF,
+    MATCHER_FLANN,
+    MATCHER_INVALID
+};
+
+enum SelectorType
+{
+    SELECTOR_NN,
+    SELECTOR_KNN,
+    SELECTOR_INVALID
+};
+
+// "SHITOMASI", "BRISK", "MAT_BF", "SEL_KNN", ... as used by TrackingConfig; *_INVALID for unknown names
+DetectorType parseDetectorType(const std::string &name);
+DescriptorType parseDescriptorType(const std::string &name);
+MatcherType parseMatcherType(const std::string &name);
+SelectorType parseSelectorType(const std::string &name);
+
+const char *detectorTypeName(DetectorType type);
+const char *descriptorTypeName(DescriptorType type);
+const char *matcherTypeName(MatcherType type);
+const char *selectorTypeName(SelectorType type);
+
+// everything but SIFT is a binary string compared by Hamming distance (DES_BINARY), SIFT is DES_HOG
+constexpr bool isBinaryDescriptor(DescriptorType type)
+{
+    return type != DESC_SIFT;
+}
+
+constexpr int descriptorNormType(DescriptorType type)
+{
+    return isBinaryDescriptor(type) ? cv::NORM_HAMMING : cv::NORM_L2;
+}
+
+constexpr int descriptorDepth(DescriptorType type)
+{
+    return isBinaryDescriptor(type) ? CV_8U : CV_32F;
+}
+
+// row size in bytes with the parameters createDescriptorExtractor uses
+constexpr int descriptorBytes(DescriptorType type)
+{
+    return type == DESC_BRISK || type == DESC_FREAK ? 64
+         : type == DESC_BRIEF || type == DESC_ORB   ? 32
+         : type == DESC_AKAZE                       ? 61
+         : type == DESC_SIFT                        ? 128 * (int)sizeof(float)
+                                                    : 0;
+}
+
+// AKAZE descriptors need the evolution level (class_id) of AKAZE keypoints, so they describe nothing else
+constexpr bool isSupportedPair(DetectorType detector, DescriptorType descriptor)
+{
+    return detector != DET_INVALID && descriptor != DESC_INVALID && !(descriptor == DESC_AKAZE && detector != DET_AKAZE);
+}
+
+// same-family pairs which can detect and describe in one pass (detectAndCompute)
+constexpr bool isFusedTypePair(DetectorType detector, DescriptorType descriptor)
+{
+    return (detector == DET_ORB && descriptor == DESC_ORB) || (detector == DET_BRISK && descriptor == DESC_BRISK) ||
+           (detector == DET_AKAZE && descriptor == DESC_AKAZE) || (detector == DET_SIFT && descriptor == DESC_SIFT);
+}
+
+// No. of pixels the image is extended by around a region of interest before detecting in it, so that the
+// detector sees the same neighbourhood at the ROI border as it would in the full frame. Sized by the
+// largest support of the detector: block size + Sobel aperture + min. distance for the corner detectors,
+// the Bresenham circle for FAST, and the pattern/edge threshold at the coarsest pyramid level for the
+// scale-space detectors (e.g. ORB: edgeThreshold 31 * 1.2^7 = 111 px at level 7).
+constexpr int detectorRoiPadding(DetectorType type)
+{
+    return type == DET_SHITOMASI || type == DET_HARRIS || type == DET_FAST ? 8
+         : type == DET_BRISK                                              ? 48
+         : type == DET_ORB                                                ? 112
+                                                                          : 64; // AKAZE, SIFT
+}
+
+#endif /* pipelineTypes_hpp */
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "quantizedMatcher.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANTIZED_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+// no. of reference rows per tile: 128 x 128 byte = 16 KB, a tile of train descriptors stays in L1
+const int trainTileRows = 128;
+
+inline int l2SqrScalar(const uchar *a, const uchar *b, int n)
+{
+    int dist = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int d = (int)a[i] - (int)b[i];
+        dist += d * d;
+    }
+    return dist;
+}
+
+// Tiled 2-NN search, same structure as the Hamming matcher's: the running best two distances of a query
+// stay in locals for the whole tile
+#define L2_KNN2_TILED(DIST)                                                                    \
+    for (int tileStart = 0; tileStart < numTrain; tileStart += trainTileRows)                 \
+    {                                                                                          \
+        int tileEnd = min(numTrain, tileStart + trainTileRows);                                \
+        for (int q = 0; q < numQuery; ++q)                                                     \
+        {                                                                                      \
+            const uchar *qRow = query + q * queryStride;                                       \
+            int best = bestDist[q], second = secondDist[q], idx = bestIdx[q];                  \
+            for (int t = tileStart; t < tileEnd; ++t)                                          \
+            {                                                                                  \
+                int d = DIST(qRow, train + t * trainStride, n);                                \
+                if (d < second)                                                                \
+                {                                                                              \
+                    if (d < best)                                                              \
+                    {                                                                          \
+                        second = best;                                                         \
+                        best = d;                                                              \
+                        idx = t;                                                               \
+                    }                                                                          \
+                    else                                                                       \
+                    {                                                                          \
+                        second = d;                                                            \
+                    }                                                                          \
+                }                                                                              \
+            }                                                                                  \
+            bestDist[q] = best;                                                                \
+            secondDist[q] = second;                                                            \
+            bestIdx[q] = idx;                                                                  \
+        }                                                                                      \
+    }
+
+void knn2Scalar(const uchar *query, size_t queryStride, int numQuery, const uchar *train, size_t trainStride,
+                int numTrain, int n, int *bestIdx, int *bestDist, int *secondDist)
+{
+    L2_KNN2_TILED(l2SqrScalar)
+}
+
+#ifdef QUANTIZED_X86
+
+// |a - b| per byte from two saturating subtractions, widened to 16 bit and squared + pairwise summed by
+// madd (2 x 255^2 fits easily into the 32 bit lanes)
+__attribute__((target("avx2"))) inline int l2SqrAvx2(const uchar *a, const uchar *b, int n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i d = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        __m256i lo = _mm256_unpacklo_epi8(d, zero), hi = _mm256_unpackhi_epi8(d, zero);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(lo, lo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(hi, hi));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s) + l2SqrScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) void knn2Avx2(const uchar *query, size_t queryStride, int numQuery, const uchar *train,
+                                              size_t trainStride, int numTrain, int n, int *bestIdx, int *bestDist,
+                                              int *secondDist)
+{
+    L2_KNN2_TILED(l2SqrAvx2)
+}
+
+bool hasAvx2()
+{
+    static const bool bAvx2 = []() {
+        __builtin_cpu_init();
+        return (bool)__builtin_cpu_supports("avx2");
+    }();
+    return bAvx2;
+}
+
+#endif /* QUANTIZED_X86 */
+
+#undef L2_KNN2_TILED
+} // namespace
+
+void quantizeRootSift(const cv::Mat &descriptors, cv::Mat &quantized)
+{
+    CV_Assert(descriptors.type() == CV_32F);
+    if (quantized.rows != descriptors.rows || quantized.cols != descriptors.cols || quantized.type() != CV_8U)
+    {
+        quantized.create(descriptors.rows, descriptors.cols, CV_8U);
+    }
+    for (int r = 0; r < descriptors.rows; ++r)
+    {
+        const float *src = descriptors.ptr<float>(r);
+        uchar *dst = quantized.ptr<uchar>(r);
+        float l1 = 0.0f;
+        for (int c = 0; c < descriptors.cols; ++c)
+        {
+            l1 += fabs(src[c]);
+        }
+        float scale = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+        for (int c = 0; c < descriptors.cols; ++c)
+        {
+            dst[c] = cv::saturate_cast<uchar>(sqrt(max(src[c], 0.0f) * scale) * rootSiftScale);
+        }
+    }
+}
+
+bool isQuantizedMatchable(const cv::Mat &descriptors)
+{
+    return descriptors.depth() == CV_8U && descriptors.channels() == 1 && descriptors.cols > 0;
+}
+
+int l2SqrU8(const uchar *a, const uchar *b, int n)
+{
+#ifdef QUANTIZED_X86
+    if (hasAvx2())
+    {
+        return l2SqrAvx2(a, b, n);
+    }
+#endif
+    return l2SqrScalar(a, b, n);
+}
+
+void matchQuantizedKnnRatio(const cv::Mat &descSource, const cv::Mat &descRef, vector<cv::DMatch> &matches,
+                            float minDescDistRatio, FrameArena *scratch)
+{
+    CV_Assert(isQuantizedMatchable(descSource) && descSource.cols == descRef.cols && descSource.type() == descRef.type());
+    if (descSource.rows == 0 || descRef.rows == 0)
+    {
+        return;
+    }
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    int numQuery = descSource.rows;
+    vector<int> &bestIdx = arena.ints.acquire(), &bestDist = arena.ints.acquire(), &secondDist = arena.ints.acquire();
+    bestIdx.assign(numQuery, -1);
+    bestDist.assign(numQuery, INT_MAX);
+    secondDist.assign(numQuery, INT_MAX);
+
+    const uchar *query = descSource.ptr(), *train = descRef.ptr();
+    size_t queryStride = descSource.step, trainStride = descRef.step;
+    int numTrain = descRef.rows, n = descSource.cols;
+#ifdef QUANTIZED_X86
+    if (hasAvx2())
+    {
+        knn2Avx2(query, queryStride, numQuery, train, trainStride, numTrain, n, bestIdx.data(), bestDist.data(),
+                 secondDist.data());
+    }
+    else
+#endif
+    {
+        knn2Scalar(query, queryStride, numQuery, train, trainStride, numTrain, n, bestIdx.data(), bestDist.data(),
+                   secondDist.data());
+    }
+
+    // squared distances: best < ratio * second  <=>  best^2 < ratio^2 * second^2
+    float ratio2 = minDescDistRatio * minDescDistRatio;
+    for (int q = 0; q < numQuery; ++q)
+    {
+        if (bestIdx[q] >= 0 && secondDist[q] != INT_MAX && bestDist[q] < ratio2 * secondDist[q])
+        {
+            matches.push_back(cv::DMatch(q, bestIdx[q], sqrt((float)bestDist[q]) / rootSiftScale));
+        }
+    }
+}
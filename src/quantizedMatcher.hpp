@@ -0,0 +1,36 @@
+#ifndef quantizedMatcher_hpp
+#define quantizedMatcher_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "frameArena.hpp"
+
+
+// Compact mode for float histogram descriptors (SIFT): every row is RootSIFT normalized (L1 normalize, then
+// element-wise square root, giving a unit L2 row whose Euclidean distance is the Hellinger distance of the
+// original histograms) and stored as uint8, i.e. 128 instead of 512 bytes per SIFT descriptor. Matching runs
+// on the quantized rows directly: brute-force 2-NN on the integer squared L2 distance with the distance ratio
+// test fused in, tiled like the Hamming matcher. AVX2 (16 bit multiply-add) if the CPU has it, scalar otherwise.
+
+// quantized value = saturate(sqrt(v / |row|_1) * rootSiftScale). RootSIFT elements above 0.5 are very rare
+// (SIFT clamps its bins at 0.2 of the norm), so this spends the 8 bits on the range actually used.
+const float rootSiftScale = 512.0f;
+
+// descriptors: CV_32F, one row per keypoint, non-negative. quantized is written in place if it already has
+// the right size and type (e.g. a FrameArena::rows view), else (re)created.
+void quantizeRootSift(const cv::Mat &descriptors, cv::Mat &quantized);
+
+// true if matchQuantizedKnnRatio can handle the descriptor matrix (CV_8U, one channel)
+bool isQuantizedMatchable(const cv::Mat &descriptors);
+
+// squared L2 distance of two uint8 rows of n elements
+int l2SqrU8(const uchar *a, const uchar *b, int n);
+
+// k=2 nearest neighbour matching of quantized rows with distance ratio test (best < ratio * second, on the
+// distances, not their squares). DMatch::distance is in RootSIFT units (L2 distance / rootSiftScale).
+// The per-query results live in scratch if given.
+void matchQuantizedKnnRatio(const cv::Mat &descSource, const cv::Mat &descRef, std::vector<cv::DMatch> &matches,
+                            float minDescDistRatio = 0.8f, FrameArena *scratch = nullptr);
+
+#endif /* quantizedMatcher_hpp */
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <opencv2/core/hal/hal.hpp>
+
+#include "quantizedMatcher.hpp"
+#include "referenceIndex.hpp"
+
+using namespace std;
+
+namespace
+{
+// reference rows per tile, kept in L1/L2 while all query rows are streamed against them
+const int trainTileRows = 256;
+
+// per-row distances; L2 ones are squared so the ratio test compares squares
+struct HammingDistance
+{
+    int n;
+    float operator()(const uchar *a, const uchar *b) const { return (float)cv::hal::normHamming(a, b, n); }
+};
+
+struct L2U8Distance
+{
+    int n;
+    float operator()(const uchar *a, const uchar *b) const { return (float)l2SqrU8(a, b, n); }
+};
+
+struct L2FloatDistance
+{
+    int n;
+    float operator()(const uchar *a, const uchar *b) const
+    {
+        return cv::hal::normL2Sqr_(reinterpret_cast<const float *>(a), reinterpret_cast<const float *>(b), n);
+    }
+};
+
+// best / second best distance and best row of every (query, reference frame) pair, stored query-major
+template <typename Distance>
+void knn2PerFrame(const cv::Mat &query, const cv::Mat &train, const vector<int> &entryFrame, int numFrames,
+                  Distance dist, float *best, float *second, int *bestRow)
+{
+    for (int tileStart = 0; tileStart < train.rows; tileStart += trainTileRows)
+    {
+        int tileEnd = min(train.rows, tileStart + trainTileRows);
+        for (int q = 0; q < query.rows; ++q)
+        {
+            const uchar *qRow = query.ptr(q);
+            float *qBest = best + q * numFrames, *qSecond = second + q * numFrames;
+            int *qBestRow = bestRow + q * numFrames;
+            for (int t = tileStart; t < tileEnd; ++t)
+            {
+                float d = dist(qRow, train.ptr(t));
+                int f = entryFrame[t];
+                if (d < qSecond[f])
+                {
+                    if (d < qBest[f])
+                    {
+                        qSecond[f] = qBest[f];
+                        qBest[f] = d;
+                        qBestRow[f] = t;
+                    }
+                    else
+                    {
+                        qSecond[f] = d;
+                    }
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+void ReferenceIndex::build(DataFrameBuffer &buffer, size_t numRefs)
+{
+    frameAges.clear();
+    frameStarts.assign(1, 0);
+    entryFrame.clear();
+    entryKeypoint.clear();
+
+    int totalRows = 0, cols = 0, type = -1;
+    for (size_t age = 1; age <= numRefs && age < buffer.size(); ++age)
+    {
+        const cv::Mat &desc = buffer.frame(age).descriptors;
+        if (desc.empty() || (type >= 0 && (desc.cols != cols || desc.type() != type)))
+        {
+            continue;
+        }
+        cols = desc.cols;
+        type = desc.type();
+        frameAges.push_back((int)age);
+        totalRows += desc.rows;
+        frameStarts.push_back(totalRows);
+    }
+
+    stacked = reuseRows(storage, totalRows, cols, type);
+    for (size_t f = 0; f < frameAges.size(); ++f)
+    {
+        const cv::Mat &desc = buffer.frame(frameAges[f]).descriptors;
+        desc.copyTo(stacked.rowRange(frameStarts[f], frameStarts[f + 1]));
+        for (int r = 0; r < desc.rows; ++r)
+        {
+            entryFrame.push_back((int)f);
+            entryKeypoint.push_back(r);
+        }
+    }
+}
+
+void matchMultiReference(const ReferenceIndex &index, const cv::Mat &descCurrent, int normType,
+                         const string &selectorType, MultiRefMatches &result, FrameArena *scratch)
+{
+    int numFrames = (int)index.numFrames();
+    result.best.clear();
+    result.perFrame.resize(numFrames);
+    for (vector<cv::DMatch> &matches : result.perFrame)
+    {
+        matches.clear();
+    }
+    const cv::Mat &train = index.descriptors();
+    if (numFrames == 0 || descCurrent.empty() || descCurrent.cols != train.cols || descCurrent.type() != train.type())
+    {
+        return;
+    }
+    FrameArena localScratch;
+    FrameArena &arena = scratch ? *scratch : localScratch;
+
+    size_t numPairs = (size_t)descCurrent.rows * numFrames;
+    vector<float> &best = arena.floats.acquire(), &second = arena.floats.acquire();
+    vector<int> &bestRow = arena.ints.acquire();
+    best.assign(numPairs, numeric_limits<float>::max());
+    second.assign(numPairs, numeric_limits<float>::max());
+    bestRow.assign(numPairs, -1);
+
+    const vector<int> &entryFrame = index.entryFrames();
+    if (normType == cv::NORM_HAMMING)
+    {
+        knn2PerFrame(descCurrent, train, entryFrame, numFrames, HammingDistance{train.cols}, best.data(), second.data(), bestRow.data());
+    }
+    else if (train.depth() == CV_8U)
+    {
+        knn2PerFrame(descCurrent, train, entryFrame, numFrames, L2U8Distance{train.cols}, best.data(), second.data(), bestRow.data());
+    }
+    else
+    {
+        CV_Assert(train.type() == CV_32F);
+        knn2PerFrame(descCurrent, train, entryFrame, numFrames, L2FloatDistance{train.cols}, best.data(), second.data(), bestRow.data());
+    }
+
+    // ratio test within every frame, then the best surviving frame per query
+    bool bKnn = selectorType.compare("SEL_KNN") == 0;
+    bool bL2 = normType != cv::NORM_HAMMING;
+    const float minDescDistRatio = 0.8f;
+    const float ratio = bL2 ? minDescDistRatio * minDescDistRatio : minDescDistRatio;
+    const vector<int> &entryKeypoint = index.entryKeypoints();
+    for (int q = 0; q < descCurrent.rows; ++q)
+    {
+        int bestFrame = -1;
+        for (int f = 0; f < numFrames; ++f)
+        {
+            size_t i = (size_t)q * numFrames + f;
+            // a frame with a single candidate cannot pass the ratio test (same as knnMatch + filtering)
+            if (bestRow[i] < 0 || (bKnn && !(second[i] != numeric_limits<float>::max() && best[i] < ratio * second[i])))
+            {
+                continue;
+            }
+            float distance = bL2 ? sqrt(best[i]) : best[i];
+            result.perFrame[f].push_back(cv::DMatch(entryKeypoint[bestRow[i]], q, distance));
+            if (bestFrame < 0 || best[i] < best[(size_t)q * numFrames + bestFrame])
+            {
+                bestFrame = f;
+            }
+        }
+        if (bestFrame >= 0)
+        {
+            size_t i = (size_t)q * numFrames + bestFrame;
+            result.best.push_back(cv::DMatch(q, entryKeypoint[bestRow[i]], index.frameAge(bestFrame), bL2 ? sqrt(best[i]) : best[i]));
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef referenceIndex_hpp
+#define referenceIndex_hpp
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataFrameBuffer.hpp"
+#include "frameArena.hpp"
+
+
+// Descriptors of the last K buffered frames stacked into one matrix, so the current frame is matched against
+// all of them in a single pass instead of K matcher calls. Every row knows the frame (by age in the buffer,
+// 1 = previous) and the keypoint it came from; the rows of a frame are contiguous. The stacked storage only
+// grows, rebuilding the index every frame copies the K descriptor sets but does not allocate.
+class ReferenceIndex
+{
+public:
+    // ages 1..numRefs of the buffer (as far as it holds them); frames without descriptors are left out
+    void build(DataFrameBuffer &buffer, size_t numRefs);
+
+    const cv::Mat &descriptors() const { return stacked; }
+    size_t numFrames() const { return frameAges.size(); }
+    int frameAge(size_t f) const { return frameAges[f]; }
+    int frameBegin(size_t f) const { return frameStarts[f]; } // first row of frame f
+    int frameEnd(size_t f) const { return frameStarts[f + 1]; }
+
+    // per-row ids: index of the reference frame (0 .. numFrames()-1) and keypoint within it
+    const std::vector<int> &entryFrames() const { return entryFrame; }
+    const std::vector<int> &entryKeypoints() const { return entryKeypoint; }
+
+private:
+    cv::Mat storage, stacked; // stacked = first rows of storage
+    std::vector<int> frameAges, frameStarts;
+    std::vector<int> entryFrame, entryKeypoint;
+};
+
+struct MultiRefMatches
+{
+    // best match of each current keypoint over all reference frames: queryIdx = current keypoint,
+    // trainIdx = keypoint of the reference frame, imgIdx = age of that frame
+    std::vector<cv::DMatch> best;
+    // [f] = matches with reference frame f (ReferenceIndex order, i.e. age f + 1 for a full buffer), indexed
+    // like DataFrame::kptMatches (queryIdx = keypoint of the reference frame, trainIdx = current keypoint) and
+    // searched from the current frame like matchFrames' index path (one reference keypoint can be the best
+    // match of several current ones); matchFrames' SIMD kernels search from the reference frame instead
+    std::vector<std::vector<cv::DMatch>> perFrame;
+};
+
+// Brute-force matching of descCurrent against every frame of the index in one tiled pass: for each query
+// row the best two distances are kept per reference frame, so the ratio test (SEL_KNN, 0.8) runs within a
+// frame (the same point seen in two references does not make the match ambiguous). SEL_NN keeps the best
+// match per frame. normType is NORM_HAMMING (binary) or NORM_L2 (float, or quantized uint8).
+// Temporaries come from scratch if given.
+void matchMultiReference(const ReferenceIndex &index, const cv::Mat &descCurrent, int normType,
+                         const std::string &selectorType, MultiRefMatches &result, FrameArena *scratch = nullptr);
+
+#endif /* referenceIndex_hpp */
@@ -0,0 +1,81 @@
+#ifndef spscQueue_hpp
+#define spscQueue_hpp
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// Bounded lock-free single-producer / single-consumer queue (ring buffer with one empty slot).
+// Exactly one thread may push and exactly one (other) thread may pop. push()/pop() spin and yield
+// while the queue is full/empty; tryPush()/tryPop() return immediately instead.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity) : slots(capacity + 1), head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = increment(t);
+        if (next == head.load(std::memory_order_acquire))
+        {
+            return false; // full
+        }
+        slots[t] = std::move(item);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false; // empty
+        }
+        item = std::move(slots[h]);
+        head.store(increment(h), std::memory_order_release);
+        return true;
+    }
+
+    // blocking variants; return the number of times the caller had to wait (back-pressure / starvation)
+    size_t push(T &item)
+    {
+        size_t waits = 0;
+        while (!tryPush(item))
+        {
+            ++waits;
+            std::this_thread::yield();
+        }
+        return waits;
+    }
+
+    size_t pop(T &item)
+    {
+        size_t waits = 0;
+        while (!tryPop(item))
+        {
+            ++waits;
+            std::this_thread::yield();
+        }
+        return waits;
+    }
+
+    size_t capacity() const { return slots.size() - 1; }
+
+private:
+    size_t increment(size_t idx) const { return (idx + 1) == slots.size() ? 0 : idx + 1; }
+
+    std::vector<T> slots;
+    // producer and consumer indices on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif /* spscQueue_hpp */
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+
+#include "streamScheduler.hpp"
+
+using namespace std;
+
+namespace
+{
+double ticksToSec(double ticks)
+{
+    return ticks / cv::getTickFrequency();
+}
+
+// s from release to deadline: the explicit budget, else one frame interval, else none (0)
+double deadlineOf(const StreamTiming &timing)
+{
+    if (timing.deadline > 0.0)
+    {
+        return timing.deadline;
+    }
+    return timing.fps > 0.0 ? 1.0 / timing.fps : 0.0;
+}
+
+// sleeps until the tick count reaches tWake
+void sleepUntilTick(double tWake)
+{
+    double remaining = ticksToSec(tWake - (double)cv::getTickCount());
+    if (remaining > 0.0)
+    {
+        this_thread::sleep_for(chrono::duration<double>(remaining));
+    }
+}
+} // namespace
+
+StreamScheduler::StreamScheduler(size_t numWorkers) : numWorkers(max<size_t>(1, numWorkers))
+{
+}
+
+StreamScheduler::~StreamScheduler() = default;
+
+void StreamScheduler::addStream(const string &name, unique_ptr<FrameSource> source, const TrackingConfig &config,
+                                const StreamTiming &timing)
+{
+    unique_ptr<Stream> stream(new Stream);
+    stream->name = name;
+    stream->source = move(source);
+    stream->config = config;
+    stream->config.bVerbose = false;
+    stream->timing = timing;
+    stream->timing.maxQueuedFrames = max<size_t>(1, timing.maxQueuedFrames);
+    stream->features.reset(new FeaturePipeline(config.detectorType, config.descriptorType, usesFusedDetDesc(config)));
+    stream->buffer.reset(new DataFrameBuffer(max(2, config.dataBufferSize)));
+    stream->report.name = name;
+    streams.push_back(move(stream));
+}
+
+void StreamScheduler::feederLoop(Stream &stream)
+{
+    // the prefetcher reads and decodes ahead, the feeder only releases finished frames on schedule
+    FramePrefetcher prefetcher(*stream.source);
+    double interval = stream.timing.fps > 0.0 ? cv::getTickFrequency() / stream.timing.fps : 0.0;
+    double deadline = deadlineOf(stream.timing) * cv::getTickFrequency();
+    double tStart = (double)cv::getTickCount();
+    cv::Mat img;
+    for (size_t i = 0; prefetcher.read(img); ++i)
+    {
+        QueuedFrame frame;
+        if (interval > 0.0)
+        {
+            sleepUntilTick(tStart + i * interval);
+        }
+        frame.img = img;
+        frame.tRelease = (double)cv::getTickCount();
+        // without a rate or budget the release time orders the frames (first come, first served)
+        frame.tDeadline = frame.tRelease + deadline;
+
+        unique_lock<mutex> lock(mtx);
+        if (stream.queue.size() >= stream.timing.maxQueuedFrames)
+        {
+            if (stream.timing.bDropWhenBehind)
+            {
+                stream.queue.pop_front();
+                ++stream.report.numDropped;
+            }
+            else
+            {
+                ++stream.report.numBackpressure;
+                queueSpace.wait(lock, [&]() { return stream.queue.size() < stream.timing.maxQueuedFrames; });
+            }
+        }
+        stream.queue.push_back(move(frame));
+        lock.unlock();
+        frameReady.notify_one();
+    }
+    {
+        lock_guard<mutex> lock(mtx);
+        stream.bEnded = true;
+    }
+    frameReady.notify_all();
+}
+
+void StreamScheduler::workerLoop()
+{
+    while (true)
+    {
+        Stream *next = nullptr;
+        QueuedFrame frame;
+        {
+            unique_lock<mutex> lock(mtx);
+            while (true)
+            {
+                // earliest deadline over the streams which have a frame waiting and are not being worked on
+                bool bAllDone = true;
+                double earliest = numeric_limits<double>::max();
+                for (unique_ptr<Stream> &stream : streams)
+                {
+                    bAllDone = bAllDone && stream->bEnded && stream->queue.empty() && !stream->bBusy;
+                    if (!stream->bBusy && !stream->queue.empty() && stream->queue.front().tDeadline < earliest)
+                    {
+                        earliest = stream->queue.front().tDeadline;
+                        next = stream.get();
+                    }
+                }
+                if (next || bAllDone)
+                {
+                    break;
+                }
+                frameReady.wait(lock);
+            }
+            if (!next)
+            {
+                return;
+            }
+            frame = move(next->queue.front());
+            next->queue.pop_front();
+            next->bBusy = true;
+        }
+        queueSpace.notify_all();
+
+        processFrame(*next, frame);
+
+        {
+            lock_guard<mutex> lock(mtx);
+            next->bBusy = false;
+        }
+        frameReady.notify_all(); // the stream may have more frames, or this was the last one of the run
+    }
+}
+
+void StreamScheduler::processFrame(Stream &stream, QueuedFrame &frame)
+{
+    double t = (double)cv::getTickCount();
+    DataFrameBuffer &buffer = *stream.buffer;
+    DataFrame &currFrame = buffer.push(frame.img);
+    detectFrame(currFrame, stream.config, *stream.features);
+    describeFrame(currFrame, stream.config, *stream.features);
+    if (buffer.size() > 1)
+    {
+        matchFrames(buffer.previous(), currFrame, stream.config);
+        verifyFrameMatches(buffer.previous(), currFrame, stream.config);
+    }
+    double tDone = (double)cv::getTickCount();
+
+    StreamReport &report = stream.report;
+    ++report.numFrames;
+    report.busyTime += ticksToSec(tDone - t);
+    report.numDeadlineMisses += deadlineOf(stream.timing) > 0.0 && tDone > frame.tDeadline;
+    stream.latencies.push_back(ticksToSec(tDone - frame.tRelease) * 1000.0);
+}
+
+vector<StreamReport> StreamScheduler::run()
+{
+    balanceThreads(numWorkers); // workers x OpenCV threads within the cores
+    double tStart = (double)cv::getTickCount();
+
+    vector<thread> feeders, workers;
+    for (unique_ptr<Stream> &stream : streams)
+    {
+        feeders.emplace_back(&StreamScheduler::feederLoop, this, ref(*stream));
+    }
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        workers.emplace_back(&StreamScheduler::workerLoop, this);
+    }
+    for (thread &feeder : feeders)
+    {
+        feeder.join();
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+    wallTimeSec = ticksToSec((double)cv::getTickCount() - tStart);
+
+    vector<StreamReport> reports;
+    for (unique_ptr<Stream> &stream : streams)
+    {
+        StreamReport report = stream->report;
+        report.throughput = wallTimeSec > 0.0 ? report.numFrames / wallTimeSec : 0.0;
+        report.latency = computeLatencyStats(stream->latencies);
+        reports.push_back(report);
+    }
+    return reports;
+}
@@ -0,0 +1,106 @@
+#ifndef streamScheduler_hpp
+#define streamScheduler_hpp
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "benchStats.hpp"
+#include "dataFrameBuffer.hpp"
+#include "featurePipeline.hpp"
+#include "featureTracking.hpp"
+#include "frameSource.hpp"
+
+
+struct StreamTiming
+{
+    double fps = 0.0;            // frame rate the source is replayed at, 0 = as fast as it can be read
+    double deadline = 0.0;       // s from a frame's release until it must be matched, 0 = one frame interval (none without fps)
+    size_t maxQueuedFrames = 4;  // released frames waiting for a worker before backpressure kicks in
+    bool bDropWhenBehind = false; // full queue: drop the oldest waiting frame (live camera) instead of pausing the source
+};
+
+// what one stream did over the run
+struct StreamReport
+{
+    std::string name;
+    size_t numFrames = 0;         // frames processed
+    size_t numDeadlineMisses = 0; // frames matched after their deadline (only counted if the stream has one)
+    size_t numDropped = 0;        // frames dropped because the stream fell behind (bDropWhenBehind)
+    size_t numBackpressure = 0;   // times the source was paused because the stream fell behind
+    double throughput = 0.0;      // frames / s over the wall time of the run
+    double busyTime = 0.0;        // s of worker time spent on the stream
+    LatencyStats latency;         // ms from release until matched
+};
+
+// Runs many camera sequences at once on one shared set of workers. Every stream owns its source (read ahead
+// by a FramePrefetcher), its DataFrame ring buffer and its detector / descriptor instances, and its frames are
+// processed strictly in order, one at a time, since matching needs the previous frame. A feeder thread per
+// stream releases frames at the stream's rate into a bounded queue; idle workers take the waiting frame with
+// the earliest deadline over all streams that are not being worked on (earliest-deadline-first). A stream
+// whose queue is full is paused at its source (or drops its oldest frame), so one stream falling behind cannot
+// take memory or workers from the others.
+class StreamScheduler
+{
+public:
+    explicit StreamScheduler(size_t numWorkers);
+    ~StreamScheduler();
+
+    StreamScheduler(const StreamScheduler &) = delete;
+    StreamScheduler &operator=(const StreamScheduler &) = delete;
+
+    // before run(); config.detectorType / descriptorType must be a supported combination
+    void addStream(const std::string &name, std::unique_ptr<FrameSource> source, const TrackingConfig &config,
+                   const StreamTiming &timing = StreamTiming());
+
+    // processes all streams to their end; returns one report per stream in the order they were added
+    std::vector<StreamReport> run();
+
+    double wallTime() const { return wallTimeSec; }
+
+private:
+    struct QueuedFrame
+    {
+        cv::Mat img;
+        double tRelease = 0.0;  // tick count
+        double tDeadline = 0.0; // tick count
+    };
+
+    struct Stream
+    {
+        std::string name;
+        std::unique_ptr<FrameSource> source;
+        TrackingConfig config;
+        StreamTiming timing;
+        std::unique_ptr<FeaturePipeline> features;
+        std::unique_ptr<DataFrameBuffer> buffer;
+
+        // guarded by the scheduler mutex
+        std::deque<QueuedFrame> queue;
+        bool bBusy = false;    // a worker is processing one of its frames
+        bool bEnded = false;   // the feeder has released its last frame
+
+        // written by the worker holding the stream (bBusy) only
+        StreamReport report;
+        std::vector<double> latencies;
+    };
+
+    void feederLoop(Stream &stream);
+    void workerLoop();
+    void processFrame(Stream &stream, QueuedFrame &frame);
+
+    size_t numWorkers;
+    std::vector<std::unique_ptr<Stream>> streams;
+    double wallTimeSec = 0.0;
+
+    std::mutex mtx;
+    std::condition_variable frameReady; // workers: a frame was queued, a stream became free or all ended
+    std::condition_variable queueSpace; // feeders: a frame was taken from a queue
+};
+
+#endif /* streamScheduler_hpp */
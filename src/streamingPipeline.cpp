@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <thread>
+
+#include "dataFrameBuffer.hpp"
+#include "streamingPipeline.hpp"
+#include "spscQueue.hpp"
+
+using namespace std;
+
+namespace
+{
+// unit of work handed from stage to stage; bEnd marks the end of the stream. The frame is one of the
+// pipeline's recycled slots, so handing an item on copies a pointer and never builds a DataFrame.
+struct PipelineItem
+{
+    size_t frameIndex = 0;
+    bool bEnd = false;
+    double tLoaded = 0.0;       // tick count when the frame entered the pipeline
+    DataFrame *frame = nullptr; // nullptr for the end marker
+};
+
+typedef SpscQueue<PipelineItem> ItemQueue;
+typedef SpscQueue<DataFrame *> SlotQueue;
+
+double ticksToSec(double ticks)
+{
+    return ticks / cv::getTickFrequency();
+}
+
+// generic middle stage: pop from in, process, push to out until the end marker passed through
+template <typename Work>
+void runStage(ItemQueue &in, ItemQueue &out, StageStats &stats, Work work)
+{
+    while (true)
+    {
+        PipelineItem item;
+        stats.inputWaits += in.pop(item);
+        if (!item.bEnd)
+        {
+            double t = (double)cv::getTickCount();
+            work(item);
+            stats.busyTime += ticksToSec((double)cv::getTickCount() - t);
+            ++stats.numFrames;
+        }
+        bool bEnd = item.bEnd;
+        stats.outputWaits += out.push(item);
+        if (bEnd)
+        {
+            return;
+        }
+    }
+}
+} // namespace
+
+PipelineResult runPipeline(const TrackingConfig &config, const FrameCache &frameCache, size_t queueCapacity,
+                           FrameCallback onFrameMatched)
+{
+    FrameCacheSource source(frameCache);
+    return runPipeline(config, source, queueCapacity, onFrameMatched);
+}
+
+PipelineResult runPipeline(const TrackingConfig &config, FrameSource &source, size_t queueCapacity,
+                           FrameCallback onFrameMatched)
+{
+    PipelineResult result;
+    result.stages.resize(4);
+    StageStats &loadStats = result.stages[0];
+    StageStats &detectStats = result.stages[1];
+    StageStats &describeStats = result.stages[2];
+    StageStats &matchStats = result.stages[3];
+    loadStats.name = "load";
+    detectStats.name = "detect";
+    describeStats.name = "describe";
+    matchStats.name = "match";
+
+    queueCapacity = max<size_t>(1, queueCapacity);
+    ItemQueue loadedQueue(queueCapacity), detectedQueue(queueCapacity), describedQueue(queueCapacity);
+
+    // Frame slots, recycled from the match stage back to the load stage. At most every queue is full, every stage
+    // holds a frame and the match stage keeps the previous one, so the load stage never waits for a free slot.
+    vector<DataFrame> slots(3 * queueCapacity + 5);
+    SlotQueue freeSlots(slots.size());
+    for (DataFrame &slot : slots)
+    {
+        DataFrame *pSlot = &slot;
+        freeSlots.push(pSlot); // before the threads start, the match stage (this thread) is the producer
+    }
+
+    // detector / descriptor instances, built before the clock starts; detect and describe thread each use their own
+    FeaturePipeline features(config.detectorType, config.descriptorType, usesFusedDetDesc(config));
+    result.setupTime = features.setupTime();
+
+    double tStart = (double)cv::getTickCount();
+
+    // #1 : load (stands in for the camera; frames come from the source, ends with its stream)
+    thread loadThread([&]() {
+        for (size_t imgIndex = 0;; imgIndex++)
+        {
+            PipelineItem item;
+            double t = (double)cv::getTickCount();
+            cv::Mat cameraImg;
+            if (!source.read(cameraImg))
+            {
+                item.bEnd = true;
+            }
+            else
+            {
+                loadStats.outputWaits += freeSlots.pop(item.frame); // cannot wait, see the slot count
+                resetFrame(*item.frame, cameraImg);
+                item.frameIndex = imgIndex;
+                item.tLoaded = t;
+                loadStats.busyTime += ticksToSec((double)cv::getTickCount() - t);
+                ++loadStats.numFrames;
+            }
+            bool bEnd = item.bEnd;
+            loadStats.outputWaits += loadedQueue.push(item);
+            if (bEnd)
+            {
+                break;
+            }
+        }
+    });
+
+    // #2 : detect (incl. vehicle ROI filter and keypoint limit)
+    thread detectThread([&]() {
+        runStage(loadedQueue, detectedQueue, detectStats,
+                 [&](PipelineItem &item) { detectFrame(*item.frame, config, features); });
+    });
+
+    // #3 : describe, and build the frame's matcher index here: the match stage queries it with the next frame
+    thread describeThread([&]() {
+        runStage(detectedQueue, describedQueue, describeStats, [&](PipelineItem &item) {
+            describeFrame(*item.frame, config, features);
+            trainFrameMatcher(*item.frame, config);
+        });
+    });
+
+    // #4 : match against the previous frame (runs on the calling thread)
+    double sumLatency = 0.0;
+    DataFrame *prevFrame = nullptr;
+    while (true)
+    {
+        PipelineItem item;
+        matchStats.inputWaits += describedQueue.pop(item);
+        if (item.bEnd)
+        {
+            break;
+        }
+
+        double t = (double)cv::getTickCount();
+        if (prevFrame)
+        {
+            matchFrames(*prevFrame, *item.frame, config);
+            verifyFrameMatches(*prevFrame, *item.frame, config);
+        }
+        if (onFrameMatched)
+        {
+            onFrameMatched(*item.frame, item.frameIndex);
+        }
+        double tDone = (double)cv::getTickCount();
+        matchStats.busyTime += ticksToSec(tDone - t);
+        ++matchStats.numFrames;
+
+        double latency = ticksToSec(tDone - item.tLoaded);
+        sumLatency += latency;
+        result.maxLatency = max(result.maxLatency, latency);
+
+        if (prevFrame)
+        {   // done with the frame before, hand its slot back to the load stage
+            freeSlots.push(prevFrame);
+        }
+        prevFrame = item.frame;
+    }
+
+    loadThread.join();
+    detectThread.join();
+    describeThread.join();
+
+    result.wallTime = ticksToSec((double)cv::getTickCount() - tStart);
+    result.numFrames = matchStats.numFrames;
+    result.avgLatency = result.numFrames > 0 ? sumLatency / result.numFrames : 0.0;
+    for (StageStats &stats : result.stages)
+    {
+        stats.occupancy = result.wallTime > 0.0 ? stats.busyTime / result.wallTime : 0.0;
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef streamingPipeline_hpp
+#define streamingPipeline_hpp
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "dataStructures.h"
+#include "featureTracking.hpp"
+#include "frameCache.hpp"
+#include "frameSource.hpp"
+
+
+// what a single pipeline stage did over the whole stream
+struct StageStats
+{
+    std::string name;
+    size_t numFrames = 0;
+    double busyTime = 0.0;  // s spent processing frames
+    double occupancy = 0.0; // busyTime / pipeline wall time; the stage closest to 1 is the bottleneck
+    size_t inputWaits = 0;  // times the stage found its input queue empty (starved)
+    size_t outputWaits = 0; // times the stage found its output queue full (back-pressure)
+};
+
+struct PipelineResult
+{
+    std::vector<StageStats> stages; // load, detect, describe, match
+    size_t numFrames = 0;
+    double wallTime = 0.0;   // s
+    double avgLatency = 0.0; // s from loading a frame until it has been matched
+    double maxLatency = 0.0; // s
+    double setupTime = 0.0;  // s spent constructing the detector/descriptor instances, not part of wallTime
+};
+
+// called by the match stage for every frame once it is complete (keypoints, descriptors, kptMatches)
+typedef std::function<void(const DataFrame &frame, size_t frameIndex)> FrameCallback;
+
+// Streams the frames through one thread per stage (load -> detect -> describe -> match) connected by
+// bounded lock-free queues, so frame N+1 is detected while frame N is described and frame N-1 is
+// matched. queueCapacity bounds the number of frames in flight between two stages. The frames are a fixed set
+// of slots recycled like DataFrameBuffer's, so their vectors, descriptor storage and arenas are reused.
+PipelineResult runPipeline(const TrackingConfig &config, const FrameCache &frameCache, size_t queueCapacity = 2,
+                           FrameCallback onFrameMatched = nullptr);
+
+// Same, with the load stage reading the source (e.g. a FramePrefetcher over a video or an open ended image
+// sequence), so streams of any length run without holding more than the frames in flight.
+PipelineResult runPipeline(const TrackingConfig &config, FrameSource &source, size_t queueCapacity = 2,
+                           FrameCallback onFrameMatched = nullptr);
+
+#endif /* streamingPipeline_hpp */
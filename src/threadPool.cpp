@@ -0,0 +1,126 @@
+#include "threadPool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    numThreads = max<size_t>(1, numThreads);
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        queues.emplace_back(new WorkQueue);
+    }
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(stateMutex);
+        bStop = true;
+    }
+    taskAvailable.notify_all();
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    size_t queueIdx;
+    {
+        // count the task before it becomes visible, so a worker can never finish it before it was counted
+        lock_guard<mutex> lock(stateMutex);
+        queueIdx = nextQueue++ % queues.size();
+        ++queuedTasks;
+        ++unfinishedTasks;
+    }
+    {
+        lock_guard<mutex> lock(queues[queueIdx]->mtx);
+        queues[queueIdx]->tasks.push_back(move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    unique_lock<mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return unfinishedTasks == 0; });
+    if (firstError)
+    {
+        exception_ptr error = firstError;
+        firstError = nullptr;
+        rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::popTask(size_t id, function<void()> &task)
+{
+    // own queue first (LIFO end) ...
+    {
+        lock_guard<mutex> lock(queues[id]->mtx);
+        if (!queues[id]->tasks.empty())
+        {
+            task = move(queues[id]->tasks.back());
+            queues[id]->tasks.pop_back();
+            return true;
+        }
+    }
+    // ... then steal the oldest task of another worker
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        WorkQueue &victim = *queues[(id + i) % queues.size()];
+        lock_guard<mutex> lock(victim.mtx);
+        if (!victim.tasks.empty())
+        {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t id)
+{
+    while (true)
+    {
+        function<void()> task;
+        if (popTask(id, task))
+        {
+            {
+                lock_guard<mutex> lock(stateMutex);
+                --queuedTasks;
+            }
+            exception_ptr error;
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                error = current_exception();
+            }
+            lock_guard<mutex> lock(stateMutex);
+            if (error && !firstError)
+            {
+                firstError = error;
+            }
+            if (--unfinishedTasks == 0)
+            {
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> lock(stateMutex);
+        taskAvailable.wait(lock, [this] { return bStop || queuedTasks > 0; });
+        if (bStop && queuedTasks == 0)
+        {
+            return;
+        }
+    }
+}
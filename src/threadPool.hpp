@@ -0,0 +1,56 @@
+#ifndef threadPool_hpp
+#define threadPool_hpp
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed-size work-stealing thread pool. Every worker owns a task deque: it pops its own work from the
+// back and, once that runs dry, steals from the front of the other workers' deques. This keeps the
+// cores busy when tasks have very different run times (e.g. FAST/BRIEF vs. AKAZE/SIFT combinations).
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+
+    // blocks until all submitted tasks have finished; rethrows the first exception thrown by a task
+    void wait();
+
+    size_t size() const { return workers.size(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mtx;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(size_t id);
+    bool popTask(size_t id, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex; // guards everything below
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t queuedTasks = 0;     // submitted, not yet picked up by a worker
+    size_t unfinishedTasks = 0; // submitted, not yet finished
+    size_t nextQueue = 0;
+    bool bStop = false;
+    std::exception_ptr firstError;
+};
+
+#endif /* threadPool_hpp */
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+
+#include "thresholdController.hpp"
+
+using namespace std;
+
+ThresholdController::ThresholdController(const string &detectorType)
+{
+    bActive = true;
+    if (detectorType.compare("FAST") == 0)
+    {   // FastFeatureDetector::create() default
+        current = 10;
+        minValue = 1;
+        maxValue = 255;
+        bInteger = true;
+    }
+    else if (detectorType.compare("BRISK") == 0)
+    {   // AGAST threshold, BRISK::create() default
+        current = 30;
+        minValue = 1;
+        maxValue = 255;
+        bInteger = true;
+    }
+    else if (detectorType.compare("ORB") == 0)
+    {   // nfeatures over the whole frame, ORB::create() default
+        current = 500;
+        minValue = 50;
+        maxValue = 20000;
+        bInteger = true;
+        bInverse = true;
+    }
+    else if (detectorType.compare("AKAZE") == 0)
+    {   // detector response threshold, AKAZE::create() default
+        current = 0.001;
+        minValue = 1e-5;
+        maxValue = 0.1;
+    }
+    else if (detectorType.compare("SHITOMASI") == 0 || detectorType.compare("HARRIS") == 0)
+    {   // CornerParams::qualityLevel
+        current = 0.01;
+        minValue = 1e-4;
+        maxValue = 0.5;
+    }
+    else
+    {
+        bActive = false;
+    }
+}
+
+double ThresholdController::value() const
+{
+    return bInteger ? round(current) : current;
+}
+
+bool ThresholdController::update(size_t numKeypoints, const AdaptiveThresholdParams &params)
+{
+    if (!bActive || ((int)numKeypoints >= params.targetMin && (int)numKeypoints <= params.targetMax))
+    {
+        return false;
+    }
+    double target = 0.5 * (params.targetMin + params.targetMax);
+    double maxStep = max(1.0, params.maxStep);
+    // no keypoints at all: the largest step towards more keypoints
+    double step = pow(max((double)numKeypoints, 1.0) / max(target, 1.0), params.gain);
+    step = min(maxStep, max(1.0 / maxStep, step));
+    if (bInverse)
+    {
+        step = 1.0 / step;
+    }
+    double before = value();
+    current = min(maxValue, max(minValue, current * step));
+    return value() != before;
+}
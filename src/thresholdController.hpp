@@ -0,0 +1,44 @@
+#ifndef thresholdController_hpp
+#define thresholdController_hpp
+
+#include <cstddef>
+#include <string>
+
+
+struct AdaptiveThresholdParams
+{
+    int targetMin = 100;  // keypoints wanted in the regions of interest (whole frame without ROI) ...
+    int targetMax = 200;  // ... band edges; inside the band the parameter is left alone
+    double gain = 0.5;    // exponent of the correction, (count / target)^gain; 1 = full step, smaller = smoother
+    double maxStep = 2.0; // the parameter changes by at most this factor per frame
+};
+
+// Feedback controller for the detector parameter which sets how many keypoints a detector returns:
+// FAST threshold, BRISK threshold, ORB nfeatures, AKAZE threshold, Shi-Tomasi / Harris quality level.
+// After every frame the no. of keypoints in the ROI is compared with the target band; outside it the parameter
+// is scaled by (count / band centre)^gain (its inverse for ORB's nfeatures), limited to maxStep per frame and
+// to the detector's valid range. Keypoint counts react to thresholds roughly like a power law, so steps in
+// the log domain converge in a few frames without overshooting. Detectors without an adjustable parameter
+// in this OpenCV version (SIFT) report isActive() == false.
+class ThresholdController
+{
+public:
+    // picks the parameter, its default value (same as the detector is created with) and range
+    explicit ThresholdController(const std::string &detectorType = "");
+
+    bool isActive() const { return bActive; }
+    bool isInteger() const { return bInteger; }
+    double value() const; // current parameter value (rounded for integer parameters)
+
+    // feeds back the keypoint count of a frame; true if value() changed
+    bool update(size_t numKeypoints, const AdaptiveThresholdParams &params);
+
+private:
+    bool bActive = false;
+    bool bInverse = false; // the parameter is a keypoint count: raise it for more keypoints
+    bool bInteger = false;
+    double current = 0.0;  // unrounded, so small integer parameters can still move in fractional steps
+    double minValue = 0.0, maxValue = 0.0;
+};
+
+#endif /* thresholdController_hpp */
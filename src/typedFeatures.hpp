@@ -0,0 +1,317 @@
+#ifndef typedFeatures_hpp
+#define typedFeatures_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/xfeatures2d.hpp>
+#include <opencv2/xfeatures2d/nonfree.hpp>
+
+#include "cornerDetector.hpp"
+#include "frameArena.hpp"
+#include "keypointBudget.hpp"
+#include "matching2D.hpp"
+#include "pipelineTypes.hpp"
+#include "thresholdController.hpp"
+
+
+// The OpenCV class behind every Feature2D detector type with its parameters (createFeatureDetector builds the
+// same), and how the adaptive threshold is applied to it
+template <DetectorType Detector>
+struct Feature2DDetector;
+
+template <>
+struct Feature2DDetector<DET_FAST>
+{
+    typedef cv::FastFeatureDetector Type;
+    static cv::Ptr<Type> create() { return cv::FastFeatureDetector::create(); }
+    static void setThreshold(cv::Ptr<Type> &detector, double value) { detector->setThreshold((int)value); }
+};
+
+template <>
+struct Feature2DDetector<DET_BRISK>
+{
+    typedef cv::BRISK Type;
+    static cv::Ptr<Type> create() { return cv::BRISK::create(); }
+    // no threshold setter in OpenCV 4.1: rebuild (with the pattern, so it still describes for fused pairs)
+    static void setThreshold(cv::Ptr<Type> &detector, double value) { detector = cv::BRISK::create((int)value); }
+};
+
+template <>
+struct Feature2DDetector<DET_ORB>
+{
+    typedef cv::ORB Type;
+    static cv::Ptr<Type> create() { return cv::ORB::create(); }
+    static void setThreshold(cv::Ptr<Type> &detector, double value) { detector->setMaxFeatures((int)value); }
+};
+
+template <>
+struct Feature2DDetector<DET_AKAZE>
+{
+    typedef cv::AKAZE Type;
+    static cv::Ptr<Type> create() { return cv::AKAZE::create(); }
+    static void setThreshold(cv::Ptr<Type> &detector, double value) { detector->setThreshold(value); }
+};
+
+template <>
+struct Feature2DDetector<DET_SIFT>
+{
+    typedef cv::xfeatures2d::SIFT Type;
+    static cv::Ptr<Type> create() { return cv::xfeatures2d::SIFT::create(); }
+    static void setThreshold(cv::Ptr<Type> &, double) {} // no adjustable parameter (ThresholdController is inactive)
+};
+
+// The OpenCV class behind every descriptor type with its parameters (createDescriptorExtractor builds the same)
+template <DescriptorType Descriptor>
+struct Feature2DExtractor;
+
+template <>
+struct Feature2DExtractor<DESC_BRISK>
+{
+    typedef cv::BRISK Type;
+    static cv::Ptr<Type> create()
+    {
+        int threshold = 30;        // FAST/AGAST detection threshold score.
+        int octaves = 3;           // detection octaves (use 0 to do single scale)
+        float patternScale = 1.0f; // apply this scale to the pattern used for sampling the neighbourhood of a keypoint.
+        return cv::BRISK::create(threshold, octaves, patternScale);
+    }
+};
+
+template <>
+struct Feature2DExtractor<DESC_BRIEF>
+{
+    typedef cv::xfeatures2d::BriefDescriptorExtractor Type;
+    static cv::Ptr<Type> create() { return cv::xfeatures2d::BriefDescriptorExtractor::create(); }
+};
+
+template <>
+struct Feature2DExtractor<DESC_ORB>
+{
+    typedef cv::ORB Type;
+    static cv::Ptr<Type> create() { return cv::ORB::create(); }
+};
+
+template <>
+struct Feature2DExtractor<DESC_FREAK>
+{
+    typedef cv::xfeatures2d::FREAK Type;
+    static cv::Ptr<Type> create() { return cv::xfeatures2d::FREAK::create(); }
+};
+
+template <>
+struct Feature2DExtractor<DESC_AKAZE>
+{
+    typedef cv::AKAZE Type;
+    static cv::Ptr<Type> create() { return cv::AKAZE::create(); }
+};
+
+template <>
+struct Feature2DExtractor<DESC_SIFT>
+{
+    typedef cv::xfeatures2d::SIFT Type;
+    static cv::Ptr<Type> create() { return cv::xfeatures2d::SIFT::create(); }
+};
+
+// Detector of a type fixed at compile time, owning its instance. The Feature2D detectors also describe for
+// fused pairs (detectAndCompute); the corner detectors are specialized below.
+template <DetectorType Detector>
+class DetectorPolicy
+{
+public:
+    DetectorPolicy() : detector(Feature2DDetector<Detector>::create()) {}
+
+    void detect(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img) { detector->detect(img, keypoints); }
+    void detectAndDescribe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+    {
+        detector->detectAndCompute(img, cv::noArray(), keypoints, descriptors);
+    }
+    void applyThreshold(double value) { Feature2DDetector<Detector>::setThreshold(detector, value); }
+
+private:
+    cv::Ptr<typename Feature2DDetector<Detector>::Type> detector;
+};
+
+// Shi-Tomasi / Harris: the tiled CornerDetector with the parameters of detKeypointsShiTomasi / detKeypointsHarris
+template <bool bHarris>
+class CornerDetectorPolicy
+{
+public:
+    CornerDetectorPolicy() : detector(makeParams()) {}
+
+    void detect(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img) { detector.detect(keypoints, img); }
+    void applyThreshold(double value) { detector.setQualityLevel(value); }
+
+private:
+    static CornerParams makeParams()
+    {
+        CornerParams params;
+        params.bHarris = bHarris;
+        return params;
+    }
+
+    CornerDetector detector;
+};
+
+template <>
+class DetectorPolicy<DET_SHITOMASI> : public CornerDetectorPolicy<false>
+{
+};
+
+template <>
+class DetectorPolicy<DET_HARRIS> : public CornerDetectorPolicy<true>
+{
+};
+
+// Descriptor of a type fixed at compile time: owns the extractor unless the detector describes (bFused), decides
+// between one detectAndCompute pass and detect + compute, and keeps the keypoints within the descriptor memory
+// budget of its own type
+template <DescriptorType Descriptor, bool bFused>
+class DescriptorPolicy
+{
+public:
+    DescriptorPolicy() : extractor(Feature2DExtractor<Descriptor>::create()) {}
+
+    void describe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+    {
+        extractor->compute(img, keypoints, descriptors);
+    }
+    template <typename DetectorPolicyT>
+    void detectAndDescribe(DetectorPolicyT &detector, std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img,
+                           cv::Mat &descriptors)
+    {
+        detector.detect(keypoints, img);
+        describe(keypoints, img, descriptors);
+    }
+
+    static bool enforceDescriptorMemory(KeypointStore &keypoints, cv::Size imgSize, const KeypointBudget &budget,
+                                        FrameArena *scratch)
+    {
+        return ::enforceDescriptorMemory(keypoints, Descriptor, imgSize, budget, scratch);
+    }
+
+private:
+    cv::Ptr<typename Feature2DExtractor<Descriptor>::Type> extractor;
+};
+
+template <DescriptorType Descriptor>
+class DescriptorPolicy<Descriptor, true>
+{
+public:
+    void describe(std::vector<cv::KeyPoint> &, const cv::Mat &, cv::Mat &) {} // described by the detector
+    template <typename DetectorPolicyT>
+    void detectAndDescribe(DetectorPolicyT &detector, std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img,
+                           cv::Mat &descriptors)
+    {
+        detector.detectAndDescribe(keypoints, img, descriptors);
+    }
+
+    static bool enforceDescriptorMemory(KeypointStore &keypoints, cv::Size imgSize, const KeypointBudget &budget,
+                                        FrameArena *scratch)
+    {
+        return ::enforceDescriptorMemory(keypoints, Descriptor, imgSize, budget, scratch);
+    }
+};
+
+// Compile-time counterpart of FeaturePipeline with the same interface, so detectFrame / describeFrame and
+// runCombination run on either. Detector, descriptor and whether they share one pass (bFused, only for the
+// same-family pairs) are template parameters: the policies own the OpenCV instances, the unused fused or
+// separate path is not instantiated and the per-frame calls neither switch on a type nor compare strings.
+template <DetectorType Detector, DescriptorType Descriptor, bool bFused = isFusedTypePair(Detector, Descriptor)>
+class TypedFeatures
+{
+    static_assert(isSupportedPair(Detector, Descriptor), "AKAZE descriptors can only describe AKAZE keypoints");
+    static_assert(!bFused || isFusedTypePair(Detector, Descriptor), "only same-family pairs detect and describe in one pass");
+
+public:
+    TypedFeatures() : thresholdController(detectorTypeName(Detector))
+    {   // setupTicks is the first member, so this spans the construction of the policies
+        setupTimeSec = ((double)cv::getTickCount() - setupTicks) / cv::getTickFrequency();
+    }
+
+    TypedFeatures(const TypedFeatures &) = delete;
+    TypedFeatures &operator=(const TypedFeatures &) = delete;
+
+    static constexpr bool isFused() { return bFused; }
+    double setupTime() const { return setupTimeSec; }
+
+    double detect(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img)
+    {
+        double t = (double)cv::getTickCount();
+        detector.detect(keypoints, img);
+        return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    }
+
+    double detectRoi(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, const std::vector<cv::Rect> &rois,
+                     FrameArena *scratch = nullptr)
+    {
+        return detectInRois(keypoints, nullptr, img, detectorRoiPadding(Detector), rois,
+                            [&](cv::Mat &subImg, std::vector<cv::KeyPoint> &roiKeypoints, cv::Mat &) {
+                                return detect(roiKeypoints, subImg);
+                            }, scratch);
+    }
+
+    double describe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+    {
+        double t = (double)cv::getTickCount();
+        descriptor.describe(keypoints, img, descriptors);
+        return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    }
+
+    double detectAndDescribe(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors)
+    {
+        double t = (double)cv::getTickCount();
+        descriptor.detectAndDescribe(detector, keypoints, img, descriptors);
+        return ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    }
+
+    double detectAndDescribeRoi(std::vector<cv::KeyPoint> &keypoints, const cv::Mat &img, cv::Mat &descriptors,
+                                const std::vector<cv::Rect> &rois, FrameArena *scratch = nullptr)
+    {
+        return detectInRois(keypoints, &descriptors, img, detectorRoiPadding(Detector), rois,
+                            [&](cv::Mat &subImg, std::vector<cv::KeyPoint> &roiKeypoints, cv::Mat &roiDescriptors) {
+                                return detectAndDescribe(roiKeypoints, subImg, roiDescriptors);
+                            }, scratch);
+    }
+
+    bool enforceDescriptorMemory(KeypointStore &keypoints, cv::Size imgSize, const KeypointBudget &budget,
+                                 FrameArena *scratch = nullptr) const
+    {
+        return DescriptorPolicy<Descriptor, bFused>::enforceDescriptorMemory(keypoints, imgSize, budget, scratch);
+    }
+
+    // same as FeaturePipeline::adaptThreshold
+    bool adaptThreshold(size_t numKeypoints, const AdaptiveThresholdParams &params)
+    {
+        if (!thresholdController.update(numKeypoints, params))
+        {
+            return false;
+        }
+        detector.applyThreshold(thresholdController.value());
+        return true;
+    }
+    bool hasAdaptiveThreshold() const { return thresholdController.isActive(); }
+    double detectorThreshold() const { return thresholdController.value(); }
+
+private:
+    int64 setupTicks = cv::getTickCount();
+    DetectorPolicy<Detector> detector;
+    DescriptorPolicy<Descriptor, bFused> descriptor;
+    ThresholdController thresholdController;
+    double setupTimeSec = 0.0;
+};
+
+// the pairs runTypedPipeline routes to, compiled once in typedPipeline.cpp (same-family pairs in both forms)
+extern template class TypedFeatures<DET_SHITOMASI, DESC_BRISK>;
+extern template class TypedFeatures<DET_FAST, DESC_BRIEF>;
+extern template class TypedFeatures<DET_FAST, DESC_ORB>;
+extern template class TypedFeatures<DET_ORB, DESC_ORB, true>;
+extern template class TypedFeatures<DET_ORB, DESC_ORB, false>;
+extern template class TypedFeatures<DET_BRISK, DESC_BRISK, true>;
+extern template class TypedFeatures<DET_BRISK, DESC_BRISK, false>;
+extern template class TypedFeatures<DET_AKAZE, DESC_AKAZE, true>;
+extern template class TypedFeatures<DET_AKAZE, DESC_AKAZE, false>;
+extern template class TypedFeatures<DET_SIFT, DESC_SIFT, true>;
+extern template class TypedFeatures<DET_SIFT, DESC_SIFT, false>;
+
+#endif /* typedFeatures_hpp */
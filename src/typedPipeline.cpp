@@ -0,0 +1,140 @@
+#include <iostream>
+
+#include "typedPipeline.hpp"
+
+using namespace std;
+
+template class TypedFeatures<DET_SHITOMASI, DESC_BRISK>;
+template class TypedFeatures<DET_FAST, DESC_BRIEF>;
+template class TypedFeatures<DET_FAST, DESC_ORB>;
+template class TypedFeatures<DET_ORB, DESC_ORB, true>;
+template class TypedFeatures<DET_ORB, DESC_ORB, false>;
+template class TypedFeatures<DET_BRISK, DESC_BRISK, true>;
+template class TypedFeatures<DET_BRISK, DESC_BRISK, false>;
+template class TypedFeatures<DET_AKAZE, DESC_AKAZE, true>;
+template class TypedFeatures<DET_AKAZE, DESC_AKAZE, false>;
+template class TypedFeatures<DET_SIFT, DESC_SIFT, true>;
+template class TypedFeatures<DET_SIFT, DESC_SIFT, false>;
+
+template class TypedPipeline<DET_SHITOMASI, DESC_BRISK>;
+template class TypedPipeline<DET_FAST, DESC_BRIEF>;
+template class TypedPipeline<DET_FAST, DESC_ORB>;
+template class TypedPipeline<DET_ORB, DESC_ORB>;
+template class TypedPipeline<DET_ORB, DESC_ORB, MATCHER_BF, SELECTOR_KNN, false>;
+template class TypedPipeline<DET_BRISK, DESC_BRISK>;
+template class TypedPipeline<DET_BRISK, DESC_BRISK, MATCHER_BF, SELECTOR_KNN, false>;
+template class TypedPipeline<DET_AKAZE, DESC_AKAZE>;
+template class TypedPipeline<DET_AKAZE, DESC_AKAZE, MATCHER_BF, SELECTOR_KNN, false>;
+template class TypedPipeline<DET_SIFT, DESC_SIFT>;
+template class TypedPipeline<DET_SIFT, DESC_SIFT, MATCHER_BF, SELECTOR_KNN, false>;
+
+namespace
+{
+// calls visitor.apply<Detector, Descriptor, bFused>() for the instantiated pair, false if there is none
+template <DetectorType Detector, DescriptorType Descriptor, typename Visitor>
+bool applyPair(bool bFused, Visitor &visitor)
+{
+    if (bFused)
+    {
+        visitor.template apply<Detector, Descriptor, isFusedTypePair(Detector, Descriptor)>();
+    }
+    else
+    {
+        visitor.template apply<Detector, Descriptor, false>();
+    }
+    return true;
+}
+
+template <typename Visitor>
+bool dispatchTypedPair(DetectorType detector, DescriptorType descriptor, bool bFused, Visitor &visitor)
+{
+    switch (detector)
+    {
+    case DET_SHITOMASI:
+        return descriptor == DESC_BRISK && applyPair<DET_SHITOMASI, DESC_BRISK>(false, visitor);
+    case DET_FAST:
+        return (descriptor == DESC_BRIEF && applyPair<DET_FAST, DESC_BRIEF>(false, visitor)) ||
+               (descriptor == DESC_ORB && applyPair<DET_FAST, DESC_ORB>(false, visitor));
+    case DET_ORB:
+        return descriptor == DESC_ORB && applyPair<DET_ORB, DESC_ORB>(bFused, visitor);
+    case DET_BRISK:
+        return descriptor == DESC_BRISK && applyPair<DET_BRISK, DESC_BRISK>(bFused, visitor);
+    case DET_AKAZE:
+        return descriptor == DESC_AKAZE && applyPair<DET_AKAZE, DESC_AKAZE>(bFused, visitor);
+    case DET_SIFT:
+        return descriptor == DESC_SIFT && applyPair<DET_SIFT, DESC_SIFT>(bFused, visitor);
+    default:
+        return false;
+    }
+}
+
+// runTypedPipeline(detectorType, descriptorType, ...): the TypedPipeline of the pair, reporting per frame
+struct SequenceRun
+{
+    const FrameCache &frameCache;
+    const TrackingConfig &base;
+
+    template <DetectorType Detector, DescriptorType Descriptor, bool bFused>
+    void apply()
+    {
+        typedef TypedPipeline<Detector, Descriptor, MATCHER_BF, SELECTOR_KNN, bFused> Pipeline;
+        Pipeline pipeline(base);
+        cout << "Typed pipeline " << detectorTypeName(Detector) << ", " << descriptorTypeName(Descriptor)
+             << (bFused ? " (fused)" : "") << ": " << (Pipeline::normType == cv::NORM_HAMMING ? "Hamming" : "L2")
+             << " norm, " << Pipeline::descBytes << " bytes per descriptor, "
+             << (Pipeline::bHammingKernel ? "SIMD Hamming kernel" : "BFMatcher") << " (setup "
+             << pipeline.setupTime() * 1000 << " ms)" << endl;
+
+        double sumDetDesc = 0.0, sumMatch = 0.0;
+        for (size_t imgIndex = 0; imgIndex < frameCache.size(); ++imgIndex)
+        {
+            TypedFrameTimes times = pipeline.process(frameCache.frame(imgIndex));
+            const DataFrame &frame = pipeline.current();
+            cout << "Frame " << imgIndex << ": " << frame.keypoints.size() << " keypoints, " << frame.kptMatches.size()
+                 << " matches, detect + describe " << (times.detect + times.describe) * 1000 << " ms, match "
+                 << times.match * 1000 << " ms" << endl;
+            sumDetDesc += times.detect + times.describe;
+            sumMatch += times.match;
+        }
+        if (frameCache.size() > 1)
+        {
+            cout << "Average: detect + describe " << sumDetDesc / frameCache.size() * 1000 << " ms, match "
+                 << sumMatch / (frameCache.size() - 1) * 1000 << " ms" << endl;
+        }
+    }
+};
+
+// runTypedPipeline(config, ...): the sweep's runCombination on the TypedFeatures of the pair
+struct CombinationRun
+{
+    const TrackingConfig &config;
+    const FrameCache &frameCache;
+    CombinationResult &result;
+
+    template <DetectorType Detector, DescriptorType Descriptor, bool bFused>
+    void apply()
+    {
+        TypedFeatures<Detector, Descriptor, bFused> features;
+        result = runCombination(config, frameCache, features);
+    }
+};
+} // namespace
+
+bool runTypedPipeline(const string &detectorType, const string &descriptorType, const FrameCache &frameCache,
+                      const TrackingConfig &base)
+{
+    SequenceRun run{frameCache, base};
+    if (!dispatchTypedPair(parseDetectorType(detectorType), parseDescriptorType(descriptorType), base.bFusedDetDesc, run))
+    {
+        cout << detectorType << ", " << descriptorType << " is not one of the typed pipeline configurations" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool runTypedPipeline(const TrackingConfig &config, const FrameCache &frameCache, CombinationResult &result)
+{
+    CombinationRun run{config, frameCache, result};
+    return dispatchTypedPair(parseDetectorType(config.detectorType), parseDescriptorType(config.descriptorType),
+                             usesFusedDetDesc(config), run);
+}
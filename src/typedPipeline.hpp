@@ -0,0 +1,181 @@
+#ifndef typedPipeline_hpp
+#define typedPipeline_hpp
+
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include "dataFrameBuffer.hpp"
+#include "featureTracking.hpp"
+#include "frameCache.hpp"
+#include "gridMatcher.hpp"
+#include "hammingMatcher.hpp"
+#include "pipelineTypes.hpp"
+#include "typedFeatures.hpp"
+
+
+// stage times of one TypedPipeline::process call in seconds (match is 0 for the first frame)
+struct TypedFrameTimes
+{
+    double detect = 0.0;
+    double describe = 0.0;
+    double match = 0.0;
+};
+
+// One detector / descriptor / matcher / selector combination fixed at compile time. Pairs which cannot work
+// (AKAZE descriptors on other keypoints) do not compile instead of being skipped at runtime. Detection and
+// description run through the TypedFeatures of the pair, whose policies own the OpenCV instances, the
+// descriptor memory budget and the fused decision (bFused), and the matching path follows statically from the
+// descriptor traits: binary descriptors with MAT_BF + SEL_KNN go straight to the SIMD Hamming kernel, anything
+// else to a matcher built once with the descriptor's norm. The ROI, budget and adaptive threshold options of
+// the base configuration apply through detectFrame / describeFrame; the matching options (gating,
+// multi-reference, KLT, quantization, verification) are left to runCombination, which runs the typed
+// features with the runtime configured matching for the sweep.
+template <DetectorType Detector, DescriptorType Descriptor, MatcherType Matcher = MATCHER_BF,
+          SelectorType Selector = SELECTOR_KNN, bool bFused = isFusedTypePair(Detector, Descriptor)>
+class TypedPipeline
+{
+    static_assert(isSupportedPair(Detector, Descriptor), "AKAZE descriptors can only describe AKAZE keypoints");
+    static_assert(Matcher != MATCHER_INVALID && Selector != SELECTOR_INVALID, "invalid matcher or selector type");
+
+public:
+    static constexpr int normType = descriptorNormType(Descriptor);
+    static constexpr int descDepth = descriptorDepth(Descriptor);
+    static constexpr int descBytes = descriptorBytes(Descriptor);
+    static constexpr bool bHammingKernel = isBinaryDescriptor(Descriptor) && Matcher == MATCHER_BF &&
+                                           Selector == SELECTOR_KNN;
+
+    explicit TypedPipeline(const TrackingConfig &base = TrackingConfig())
+        : config(makeConfig(base)), buffer(2), matcher(makeMatcher(config.lshParams))
+    {
+    }
+
+    TypedPipeline(const TypedPipeline &) = delete;
+    TypedPipeline &operator=(const TypedPipeline &) = delete;
+
+    // detects and describes img and matches it against the previous frame; the results are in current()
+    TypedFrameTimes process(const cv::Mat &img)
+    {
+        TypedFrameTimes times;
+        DataFrame &currFrame = buffer.push(img);
+        times.detect = detectFrame(currFrame, config, features);
+        times.describe = describeFrame(currFrame, config, features);
+        if (buffer.size() > 1)
+        {
+            DataFrame &prevFrame = buffer.previous();
+            double t = (double)cv::getTickCount();
+            if (!prevFrame.descriptors.empty() && !currFrame.descriptors.empty())
+            {
+                match(prevFrame.descriptors, currFrame.descriptors, currFrame.kptMatches, currFrame.scratch,
+                      std::integral_constant<bool, bHammingKernel>());
+            }
+            times.match = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+            updateKeypointFlow(prevFrame.keypoints, currFrame);
+        }
+        return times;
+    }
+
+    DataFrame &current() { return buffer.current(); }
+    const TrackingConfig &trackingConfig() const { return config; }
+    double setupTime() const { return features.setupTime(); }
+
+private:
+    static TrackingConfig makeConfig(TrackingConfig config)
+    {
+        config.detectorType = detectorTypeName(Detector);
+        config.descriptorType = descriptorTypeName(Descriptor);
+        config.matcherType = matcherTypeName(Matcher);
+        config.selectorType = selectorTypeName(Selector);
+        config.bFusedDetDesc = bFused; // keeps usesFusedDetDesc and the FeatureStore key in line with the features
+        config.bQuantizeFloat = false; // the matcher expects descDepth rows
+        return config;
+    }
+
+    static cv::Ptr<cv::DescriptorMatcher> makeMatcher(const LshParams &lshParams)
+    {
+        if (bHammingKernel)
+        {
+            return cv::Ptr<cv::DescriptorMatcher>(); // no matcher object
+        }
+        if (Matcher == MATCHER_BF)
+        {
+            return cv::BFMatcher::create(normType, false);
+        }
+        if (isBinaryDescriptor(Descriptor))
+        {   // multi-probe LSH on the raw bits
+            return cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::LshIndexParams>(
+                lshParams.tableNumber, lshParams.keySize, lshParams.multiProbeLevel));
+        }
+        return cv::makePtr<cv::FlannBasedMatcher>(); // randomized KD-trees on the float rows
+    }
+
+    // binary descriptors, MAT_BF + SEL_KNN: ratio test fused into the SIMD search
+    void match(const cv::Mat &descPrev, const cv::Mat &descCurr, std::vector<cv::DMatch> &matches, FrameArena &scratch,
+               std::true_type)
+    {
+        matchHammingKnnRatio(descPrev, descCurr, matches, 0.8f, &scratch);
+    }
+
+    // the previous frame's descriptors are the queries, as in matchDescriptors
+    void match(const cv::Mat &descPrev, const cv::Mat &descCurr, std::vector<cv::DMatch> &matches, FrameArena &scratch,
+               std::false_type)
+    {
+        if (Selector == SELECTOR_NN)
+        {
+            matcher->match(descPrev, descCurr, matches);
+            return;
+        }
+        std::vector<std::vector<cv::DMatch>> &knnMatches = scratch.knnMatches.acquire();
+        matcher->knnMatch(descPrev, descCurr, knnMatches, 2);
+        const float minDescDistRatio = 0.8f;
+        for (const std::vector<cv::DMatch> &candidates : knnMatches)
+        {
+            if (candidates.size() == 2 && candidates[0].distance < minDescDistRatio * candidates[1].distance)
+            {
+                matches.push_back(candidates[0]);
+            }
+        }
+    }
+
+    TrackingConfig config;
+    TypedFeatures<Detector, Descriptor, bFused> features;
+    DataFrameBuffer buffer;
+    cv::Ptr<cv::DescriptorMatcher> matcher;
+};
+
+template <DetectorType Detector, DescriptorType Descriptor, MatcherType Matcher, SelectorType Selector, bool bFused>
+constexpr int TypedPipeline<Detector, Descriptor, Matcher, Selector, bFused>::normType;
+template <DetectorType Detector, DescriptorType Descriptor, MatcherType Matcher, SelectorType Selector, bool bFused>
+constexpr int TypedPipeline<Detector, Descriptor, Matcher, Selector, bFused>::descDepth;
+template <DetectorType Detector, DescriptorType Descriptor, MatcherType Matcher, SelectorType Selector, bool bFused>
+constexpr int TypedPipeline<Detector, Descriptor, Matcher, Selector, bFused>::descBytes;
+template <DetectorType Detector, DescriptorType Descriptor, MatcherType Matcher, SelectorType Selector, bool bFused>
+constexpr bool TypedPipeline<Detector, Descriptor, Matcher, Selector, bFused>::bHammingKernel;
+
+// the common configurations are compiled once, in typedPipeline.cpp (same-family pairs also describing separately)
+extern template class TypedPipeline<DET_SHITOMASI, DESC_BRISK>;
+extern template class TypedPipeline<DET_FAST, DESC_BRIEF>;
+extern template class TypedPipeline<DET_FAST, DESC_ORB>;
+extern template class TypedPipeline<DET_ORB, DESC_ORB>;
+extern template class TypedPipeline<DET_ORB, DESC_ORB, MATCHER_BF, SELECTOR_KNN, false>;
+extern template class TypedPipeline<DET_BRISK, DESC_BRISK>;
+extern template class TypedPipeline<DET_BRISK, DESC_BRISK, MATCHER_BF, SELECTOR_KNN, false>;
+extern template class TypedPipeline<DET_AKAZE, DESC_AKAZE>;
+extern template class TypedPipeline<DET_AKAZE, DESC_AKAZE, MATCHER_BF, SELECTOR_KNN, false>;
+extern template class TypedPipeline<DET_SIFT, DESC_SIFT>;
+extern template class TypedPipeline<DET_SIFT, DESC_SIFT, MATCHER_BF, SELECTOR_KNN, false>;
+
+// Runs the frames through the instantiated TypedPipeline (MAT_BF, SEL_KNN) of detectorType x descriptorType
+// (fused as base.bFusedDetDesc allows) and prints keypoints, matches and stage times per frame. Returns false
+// if the pair is not among them.
+bool runTypedPipeline(const std::string &detectorType, const std::string &descriptorType, const FrameCache &frameCache,
+                      const TrackingConfig &base);
+
+// Runs config over the frames like runCombination, on the TypedFeatures of the pair (fused as
+// usesFusedDetDesc(config)) with the runtime configured matching. Returns false, leaving result untouched, if
+// the pair has no TypedFeatures instantiation.
+bool runTypedPipeline(const TrackingConfig &config, const FrameCache &frameCache, CombinationResult &result);
+
+#endif /* typedPipeline_hpp */